@@ -7,6 +7,17 @@
 #include "pak.h"
 #include <iostream>
 #include <fstream>
+#include <functional>
+#include <deque>
+#include <condition_variable>
+#include <mutex>
+#include <algorithm>
+#include <filesystem>
+#include <memory_resource>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
 
 using namespace rbpak;
 
@@ -15,6 +26,50 @@ void ProgressReporter(size_t current, size_t total, std::string_view filename) {
     std::cout << "[" << current << "/" << total << "] Processing: " << filename << std::endl;
 }
 
+// Failed steps and round trips that came back different; main reports them and fails
+static std::atomic<int> g_failures{ 0 };
+
+bool Succeeded(const PackageResult& result, std::string_view step) {
+    if (result) return true;
+    ++g_failures;
+    std::cout << step << " failed: " << result.message << std::endl;
+    return false;
+}
+
+// Text-like data with some noise, so it compresses the way real assets do
+ByteArray MakeSample(size_t size, uint32_t seed) {
+    ByteArray data(size);
+    uint32_t state = seed * 2654435761u + 1;
+    for (size_t i = 0; i < size; ++i) {
+        state = state * 1664525u + 1013904223u;
+        data[i] = (state >> 28) == 0 ? static_cast<uint8_t>(state >> 20) : static_cast<uint8_t>('a' + (i / 7 + seed) % 26);
+    }
+    return data;
+}
+
+// Reads name back and compares it with the bytes that were added
+bool CheckEntry(Package& pak, std::string_view name, const ByteArray& expected) {
+    auto data = pak.Get(name);
+    bool same = data && *data == expected;
+    if (!same) {
+        ++g_failures;
+        std::cout << "  " << name << ": MISMATCH" << std::endl;
+    }
+    return same;
+}
+
+// Reads an extracted file back and compares it with the bytes that were added
+bool CheckExtracted(const std::filesystem::path& path, const ByteArray& expected) {
+    std::ifstream file(path, std::ios::binary);
+    ByteArray data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    bool same = file.is_open() && data == expected;
+    if (!same) {
+        ++g_failures;
+        std::cout << "  " << path.string() << ": MISMATCH" << std::endl;
+    }
+    return same;
+}
+
 // Example 1: Basic usage - Create a package
 void Example_CreatePackage() {
     std::cout << "\n=== Example 1: Create Package ===" << std::endl;
@@ -260,6 +315,899 @@ void Example_OperatorOverload() {
     }
 }
 
+// Example 11: Decode into caller-owned memory
+void Example_GetInto() {
+    std::cout << "\n=== Example 11: Get Into Buffer ===" << std::endl;
+
+    Package pak;
+    if (!pak.Load("example.pak")) return;
+
+    // Query the size first, then decode straight into our own buffer
+    if (auto size = pak.GetSize("image.png")) {
+        std::vector<uint8_t> staging(*size);
+        if (auto result = pak.GetInto("image.png", staging); result) {
+            std::cout << "Decoded " << staging.size() << " bytes into staging buffer" << std::endl;
+        }
+        else {
+            std::cout << "GetInto failed: " << result.message << std::endl;
+        }
+
+        // The bytes match what was added in Example 1
+        ByteArray expected = { 0x89, 0x50, 0x4E, 0x47 };
+        if (staging != expected) {
+            ++g_failures;
+            std::cout << "  image.png: MISMATCH" << std::endl;
+        }
+    }
+
+    // A buffer smaller than GetSize is refused rather than overrun
+    std::vector<uint8_t> small(2);
+    if (auto result = pak.GetInto("image.png", small); !result) {
+        std::cout << "Expected error: " << result.message << std::endl;
+    }
+}
+
+// Example 12: Large entries stored as blocks and inflated in parallel
+void Example_ParallelInflate() {
+    std::cout << "\n=== Example 12: Parallel Inflate ===" << std::endl;
+
+    // Entries at least parallel_threshold bytes are split into chunk_size blocks
+    PackageConfig config;
+    config.parallel_threshold = 2 * 1024 * 1024;
+    config.chunk_size = 256 * 1024;
+
+    ByteArray level = MakeSample(6 * 1024 * 1024 + 17, 1);
+    {
+        Package pak(config);
+        if (!Succeeded(pak.Add("level.bin", level), "Add") || !Succeeded(pak.Save("chunked.pak"), "Save")) return;
+    }
+
+    Package pak(config);
+    if (!Succeeded(pak.Load("chunked.pak"), "Load")) return;
+    if (CheckEntry(pak, "level.bin", level)) {
+        std::cout << "Inflated " << pak_utils::FormatSize(level.size()) << " from "
+            << pak_utils::FormatSize(pak.GetCompressedSize()) << " of blocks" << std::endl;
+    }
+}
+
+// Example 13: Entries of known size inflate in one pass, at every compression level
+void Example_FastInflate() {
+    std::cout << "\n=== Example 13: Fast Inflate ===" << std::endl;
+
+    const CompressionLevel levels[] = { CompressionLevel::Fast, CompressionLevel::Balanced, CompressionLevel::Best };
+    const char* names[] = { "fast.bin", "balanced.bin", "best.bin" };
+    ByteArray texture = MakeSample(512 * 1024 + 3, 2);
+    for (size_t i = 0; i < 3; ++i) {
+        PackageConfig config;
+        config.compression = levels[i];
+        std::string path = std::string("inflate_") + std::to_string(i) + ".pak";
+        {
+            Package pak(config);
+            if (!Succeeded(pak.Add(names[i], texture), "Add") || !Succeeded(pak.Save(path), "Save")) return;
+        }
+
+        Package pak(config);
+        if (!Succeeded(pak.Load(path), "Load")) return;
+        auto start = std::chrono::steady_clock::now();
+        bool same = CheckEntry(pak, names[i], texture);
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (same) std::cout << names[i] << ": " << pak_utils::FormatSize(pak.GetCompressedSize()) << " inflated in " << elapsed << " ms" << std::endl;
+    }
+}
+
+// Example 14: Many threads reading small entries reuse their zlib streams
+void Example_ThreadContexts() {
+    std::cout << "\n=== Example 14: Per-Thread Contexts ===" << std::endl;
+
+    std::vector<std::pair<std::string, ByteArray>> files;
+    for (uint32_t i = 0; i < 200; ++i) {
+        files.emplace_back("sprite" + std::to_string(i) + ".bin", MakeSample(2048 + i * 31, 100 + i));
+    }
+    {
+        Package pak;
+        if (!Succeeded(pak.AddMultiple(files), "AddMultiple") || !Succeeded(pak.Save("sprites.pak"), "Save")) return;
+    }
+
+    // No cache, so every read inflates again on the reading thread's own stream
+    PackageConfig config;
+    config.max_cache_size = 0;
+    Package pak(config);
+    if (!Succeeded(pak.Load("sprites.pak"), "Load")) return;
+
+    std::atomic<int> matched{ 0 };
+    std::vector<std::thread> readers;
+    for (size_t t = 0; t < 4; ++t) {
+        readers.emplace_back([&, t] {
+            for (size_t i = t; i < files.size(); i += 4) {
+                if (CheckEntry(pak, files[i].first, files[i].second)) ++matched;
+            }
+        });
+    }
+    for (auto& reader : readers) reader.join();
+    std::cout << matched << "/" << files.size() << " entries matched across 4 threads" << std::endl;
+}
+
+// Example 15: Staging buffers for compressed reads come from a pool
+void Example_BufferPool() {
+    std::cout << "\n=== Example 15: Buffer Pool ===" << std::endl;
+
+    ByteArray mesh = MakeSample(256 * 1024, 3);
+    {
+        Package pak;
+        if (!Succeeded(pak.Add("mesh.bin", mesh), "Add") || !Succeeded(pak.Save("pool.pak"), "Save")) return;
+    }
+
+    PackageConfig config;
+    config.max_cache_size = 0;
+    Package pak(config);
+    if (!Succeeded(pak.Load("pool.pak"), "Load")) return;
+
+    // Each uncached read stages the compressed bytes; after the first, the buffer is reused
+    for (int i = 0; i < 8; ++i) {
+        if (!CheckEntry(pak, "mesh.bin", mesh)) return;
+    }
+    BufferPoolStats stats = pak.GetBufferPoolStats();
+    std::cout << "Acquisitions: " << stats.acquisitions << ", reused: " << stats.reuses
+        << ", allocated: " << stats.allocations << ", retained: " << pak_utils::FormatSize(stats.retained_bytes) << std::endl;
+}
+
+// Example 16: All package memory from a caller-provided std::pmr resource
+void Example_MemoryResource() {
+    std::cout << "\n=== Example 16: Memory Resource ===" << std::endl;
+
+    ByteArray audio = MakeSample(300 * 1024, 4);
+    ByteArray script = MakeSample(900, 5);
+
+    // The resource must outlive every package using it
+    std::pmr::synchronized_pool_resource pool;
+    PackageConfig config;
+    config.memory_resource = &pool;
+    {
+        Package pak(config);
+        if (!Succeeded(pak.Add("audio.ogg", audio), "Add") || !Succeeded(pak.Add("main.lua", script), "Add") ||
+            !Succeeded(pak.Save("pmr.pak"), "Save")) {
+            return;
+        }
+    }
+
+    Package pak(config);
+    if (!Succeeded(pak.Load("pmr.pak"), "Load")) return;
+    if (CheckEntry(pak, "audio.ogg", audio) && CheckEntry(pak, "main.lua", script)) {
+        std::cout << "Entries, directory and cache allocated from the pool; round trip matches" << std::endl;
+    }
+}
+
+// Example 17: Cache storage carved from one preallocated arena
+void Example_ArenaCache() {
+    std::cout << "\n=== Example 17: Arena Cache ===" << std::endl;
+
+    std::vector<std::pair<std::string, ByteArray>> files;
+    for (uint32_t i = 0; i < 24; ++i) files.emplace_back("tile" + std::to_string(i), MakeSample(1000 + i * 4000, 200 + i));
+    {
+        Package pak;
+        if (!Succeeded(pak.AddMultiple(files), "AddMultiple") || !Succeeded(pak.Save("arena.pak"), "Save")) return;
+    }
+
+    // Smaller than the package, so the slab classes evict and refill
+    PackageConfig config;
+    config.cache_storage = CacheStorage::Arena;
+    config.max_cache_size = 1024 * 1024;
+    Package pak(config);
+    if (!Succeeded(pak.Load("arena.pak"), "Load")) return;
+    for (int pass = 0; pass < 2; ++pass) {
+        for (const auto& [name, data] : files) {
+            if (!CheckEntry(pak, name, data)) return;
+        }
+    }
+    std::cout << "Cached " << pak_utils::FormatSize(pak.GetCacheSize()) << " of " << pak_utils::FormatSize(pak.GetCacheCapacity())
+        << " arena; round trip matches" << std::endl;
+}
+
+// Example 18: Per-thread front caches stay correct while an entry is replaced
+void Example_FrontCache() {
+    std::cout << "\n=== Example 18: Front Cache ===" << std::endl;
+
+    ByteArray old_config = MakeSample(4096, 6);
+    ByteArray new_config = MakeSample(4096, 7);
+    {
+        Package pak;
+        if (!Succeeded(pak.Add("config.ini", old_config), "Add") || !Succeeded(pak.Save("front.pak"), "Save")) return;
+    }
+
+    PackageConfig config;
+    config.front_cache_entries = 64;
+    Package pak(config);
+    if (!Succeeded(pak.Load("front.pak"), "Load")) return;
+
+    // Readers hammer the hot entry while the main thread replaces it; each read is one version or the other
+    std::atomic<bool> replaced{ false };
+    std::atomic<int> torn{ 0 }, stale{ 0 };
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&] {
+            while (!replaced) {
+                auto data = pak.Get("config.ini");
+                if (!data || (*data != old_config && *data != new_config)) ++torn;
+            }
+            // Once Add has returned, no thread may still serve the old bytes from its front cache
+            auto data = pak.Get("config.ini");
+            if (!data || *data != new_config) ++stale;
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    bool added = Succeeded(pak.Add("config.ini", new_config), "Add");
+    replaced = true;
+    for (auto& reader : readers) reader.join();
+    if (!added) return;
+    g_failures += torn + stale;
+    std::cout << "Torn reads: " << torn << ", stale reads after replace: " << stale << std::endl;
+
+    // The replacement survives a save and load
+    if (Succeeded(pak.Save("front2.pak"), "Save")) {
+        Package reloaded(config);
+        if (Succeeded(reloaded.Load("front2.pak"), "Load") && CheckEntry(reloaded, "config.ini", new_config)) {
+            std::cout << "Replaced entry round trip matches" << std::endl;
+        }
+    }
+}
+
+// Example 19: A compressed tier behind a small decoded cache
+void Example_CompressedCache() {
+    std::cout << "\n=== Example 19: Compressed Cache ===" << std::endl;
+
+    std::vector<std::pair<std::string, ByteArray>> files;
+    for (uint32_t i = 0; i < 8; ++i) files.emplace_back("anim" + std::to_string(i), MakeSample(128 * 1024, 300 + i));
+    {
+        Package pak;
+        if (!Succeeded(pak.AddMultiple(files), "AddMultiple") || !Succeeded(pak.Save("tiered.pak"), "Save")) return;
+    }
+
+    // Decoded cache holds two entries; the rest are kept compressed and inflated without touching the file
+    PackageConfig config;
+    config.max_cache_size = 300 * 1024;
+    config.compressed_cache_size = 4 * 1024 * 1024;
+    Package pak(config);
+    if (!Succeeded(pak.Load("tiered.pak"), "Load")) return;
+    for (int pass = 0; pass < 3; ++pass) {
+        for (const auto& [name, data] : files) {
+            if (!CheckEntry(pak, name, data)) return;
+        }
+    }
+    std::cout << "Decoded cache: " << pak_utils::FormatSize(pak.GetCacheSize())
+        << ", compressed tier: " << pak_utils::FormatSize(pak.GetCompressedCacheSize()) << std::endl;
+}
+
+// Example 20: Decoded copies kept on disk for the next run
+void Example_DiskCache() {
+    std::cout << "\n=== Example 20: Disk Cache ===" << std::endl;
+
+    ByteArray terrain = MakeSample(2 * 1024 * 1024, 8);
+    {
+        Package pak;
+        if (!Succeeded(pak.Add("terrain.raw", terrain), "Add") || !Succeeded(pak.Save("terrain.pak"), "Save")) return;
+    }
+
+    std::filesystem::remove_all("disk_cache");
+    PackageConfig config;
+    config.disk_cache_directory = "disk_cache";
+    config.disk_cache_min_hits = 1;
+    config.max_cache_size = 0; // Every read goes past the memory cache
+
+    // First run decodes from the package and writes the copy; the second maps it instead of inflating
+    for (int run = 1; run <= 2; ++run) {
+        Package pak(config);
+        if (!Succeeded(pak.Load("terrain.pak"), "Load")) return;
+        auto start = std::chrono::steady_clock::now();
+        if (!CheckEntry(pak, "terrain.raw", terrain)) return;
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Run " << run << ": read in " << elapsed << " ms" << std::endl;
+    }
+
+    size_t files = 0;
+    for (const auto& file : std::filesystem::recursive_directory_iterator("disk_cache")) files += file.is_regular_file();
+    std::cout << "Disk cache holds " << files << " file(s)" << std::endl;
+}
+
+// Example 21: A host-wide shared-memory cache of decoded entries
+void Example_SharedCache() {
+    std::cout << "\n=== Example 21: Shared Cache ===" << std::endl;
+
+    ByteArray font = MakeSample(400 * 1024, 9);
+    {
+        Package pak;
+        if (!Succeeded(pak.Add("font.ttf", font), "Add") || !Succeeded(pak.Save("shared.pak"), "Save")) return;
+    }
+
+    // Every process naming the same segment shares what any of them decoded; here two packages stand in
+    PackageConfig config;
+    config.shared_cache_name = "rbpak_example";
+    config.shared_cache_size = 8 * 1024 * 1024;
+    Package first(config), second(config);
+    if (!first.HasSharedCache()) {
+        std::cout << "Shared cache not available on this platform" << std::endl;
+    }
+    if (!Succeeded(first.Load("shared.pak"), "Load") || !Succeeded(second.Load("shared.pak"), "Load")) return;
+    if (CheckEntry(first, "font.ttf", font) && CheckEntry(second, "font.ttf", font)) {
+        std::cout << "Second package read the entry "
+            << (second.HasSharedCache() ? "from the shared segment" : "from the file") << "; round trip matches" << std::endl;
+    }
+}
+
+// Example 22: Pinning and priorities decide what survives eviction
+void Example_Pinning() {
+    std::cout << "\n=== Example 22: Pinning ===" << std::endl;
+
+    ByteArray ui = MakeSample(200 * 1024, 10);
+    std::vector<std::pair<std::string, ByteArray>> files = { { "ui.atlas", ui } };
+    for (uint32_t i = 0; i < 6; ++i) files.emplace_back("level" + std::to_string(i), MakeSample(150 * 1024, 400 + i));
+    {
+        Package pak;
+        if (!Succeeded(pak.AddMultiple(files), "AddMultiple") || !Succeeded(pak.Save("pinned.pak"), "Save")) return;
+    }
+
+    PackageConfig config;
+    config.max_cache_size = 400 * 1024;
+    config.pinned_cache_size = 256 * 1024;
+    Package pak(config);
+    if (!Succeeded(pak.Load("pinned.pak"), "Load") || !Succeeded(pak.Pin("ui.atlas"), "Pin")) return;
+    pak.SetCachePriority("level0", CachePriority::High);
+
+    // Streaming the levels evicts the rest, never the pinned atlas
+    for (const auto& [name, data] : files) {
+        if (!CheckEntry(pak, name, data)) return;
+    }
+    std::cout << "Pinned: " << pak_utils::FormatSize(pak.GetPinnedSize()) << ", cached: " << pak_utils::FormatSize(pak.GetCacheSize()) << std::endl;
+    if (CheckEntry(pak, "ui.atlas", ui) && pak.Unpin("ui.atlas")) {
+        std::cout << "Unpinned ui.atlas; pinned now " << pak_utils::FormatSize(pak.GetPinnedSize()) << std::endl;
+    }
+}
+
+// Example 23: Resizing the cache and reacting to memory pressure
+void Example_CacheResizing() {
+    std::cout << "\n=== Example 23: Cache Resizing ===" << std::endl;
+
+    std::vector<std::pair<std::string, ByteArray>> files;
+    for (uint32_t i = 0; i < 10; ++i) files.emplace_back("chunk" + std::to_string(i), MakeSample(100 * 1024, 500 + i));
+    {
+        Package pak;
+        if (!Succeeded(pak.AddMultiple(files), "AddMultiple") || !Succeeded(pak.Save("resize.pak"), "Save")) return;
+    }
+
+    PackageConfig config;
+    config.memory_pressure_callback = [](MemoryPressure level) {
+        std::cout << "Pressure callback: level " << static_cast<int>(level) << std::endl;
+    };
+    Package pak(config);
+    if (!Succeeded(pak.Load("resize.pak"), "Load")) return;
+    auto read_all = [&] {
+        for (const auto& [name, data] : files) {
+            if (!CheckEntry(pak, name, data)) return false;
+        }
+        return true;
+    };
+    if (!read_all()) return;
+    std::cout << "Cached " << pak_utils::FormatSize(pak.GetCacheSize()) << std::endl;
+
+    pak.SetCacheCapacity(256 * 1024);
+    std::cout << "After shrinking to " << pak_utils::FormatSize(pak.GetCacheCapacity()) << ": " << pak_utils::FormatSize(pak.GetCacheSize()) << std::endl;
+
+    // Hosts without automatic monitoring can forward their own signals
+    pak.OnMemoryPressure(MemoryPressure::Critical);
+    std::cout << "After critical pressure: " << pak_utils::FormatSize(pak.GetCacheSize()) << std::endl;
+    pak.OnMemoryPressure(MemoryPressure::None);
+
+    // Nothing is lost, only decoded again
+    if (read_all()) std::cout << "Round trip matches after resizing" << std::endl;
+}
+
+// Example 24: Estimating the hit ratio at other cache sizes, and sizing the cache from it
+void Example_MissRatioCurve() {
+    std::cout << "\n=== Example 24: Miss Ratio Curve ===" << std::endl;
+
+    std::vector<std::pair<std::string, ByteArray>> files;
+    for (uint32_t i = 0; i < 40; ++i) files.emplace_back("prop" + std::to_string(i), MakeSample(16 * 1024, 600 + i));
+    {
+        Package pak;
+        if (!Succeeded(pak.AddMultiple(files), "AddMultiple") || !Succeeded(pak.Save("mrc.pak"), "Save")) return;
+    }
+
+    PackageConfig config;
+    config.track_miss_ratio = true;
+    config.miss_ratio_sample_rate = 1.0; // Few entries, so track them all
+    config.target_hit_ratio = 0.8;
+    config.min_auto_cache_size = 64 * 1024;
+    Package pak(config);
+    if (!Succeeded(pak.Load("mrc.pak"), "Load")) return;
+
+    // A skewed pattern: the first eight props take most accesses
+    for (size_t i = 0; i < 5000; ++i) { // The cache is resized every 4096 tracked accesses
+        size_t index = (i % 4 != 0) ? i % 8 : i % files.size();
+        if (!CheckEntry(pak, files[index].first, files[index].second)) return;
+    }
+    for (const auto& point : pak.GetMissRatioCurve()) {
+        if (point.hit_ratio > 0.0) std::cout << "  " << pak_utils::FormatSize(point.capacity) << " -> " << point.hit_ratio * 100.0 << "% hits" << std::endl;
+    }
+    std::cout << "Auto-sized cache for 80% hits: " << pak_utils::FormatSize(pak.GetCacheCapacity()) << std::endl;
+}
+
+// Example 25: Remembering the hot entries and warming the cache with them in the next run
+void Example_CacheManifest() {
+    std::cout << "\n=== Example 25: Cache Manifest ===" << std::endl;
+
+    std::vector<std::pair<std::string, ByteArray>> files;
+    for (uint32_t i = 0; i < 20; ++i) files.emplace_back("level" + std::to_string(i), MakeSample(32 * 1024, 700 + i));
+    {
+        Package pak;
+        if (!Succeeded(pak.AddMultiple(files), "AddMultiple") || !Succeeded(pak.Save("manifest.pak"), "Save")) return;
+    }
+
+    // First run: touch a few entries and remember them
+    {
+        Package pak;
+        if (!Succeeded(pak.Load("manifest.pak"), "Load")) return;
+        for (size_t i = 0; i < 5; ++i) {
+            if (!CheckEntry(pak, files[i].first, files[i].second)) return;
+        }
+        if (!Succeeded(pak.SaveCacheManifest("manifest.txt"), "SaveCacheManifest")) return;
+    }
+
+    // Second run: the same entries are decoded before anyone asks for them
+    Package pak;
+    if (!Succeeded(pak.Load("manifest.pak"), "Load")) return;
+    if (!Succeeded(pak.WarmFromManifest("manifest.txt"), "WarmFromManifest")) return;
+    pak.WaitForWarmup();
+    std::cout << "Warmed " << pak_utils::FormatSize(pak.GetCacheSize()) << " from manifest.txt" << std::endl;
+
+    for (size_t i = 0; i < 5; ++i) {
+        if (!CheckEntry(pak, files[i].first, files[i].second)) return;
+    }
+    std::cout << "Round trip matches after warmup" << std::endl;
+}
+
+// Example 26: Learning access order and prefetching successors, within a bandwidth limit
+void Example_Prefetching() {
+    std::cout << "\n=== Example 26: Prefetching ===" << std::endl;
+
+    std::vector<std::pair<std::string, ByteArray>> files;
+    for (uint32_t i = 0; i < 8; ++i) files.emplace_back("scene" + std::to_string(i), MakeSample(64 * 1024, 800 + i));
+    {
+        Package pak;
+        if (!Succeeded(pak.AddMultiple(files), "AddMultiple") || !Succeeded(pak.Save("prefetch.pak"), "Save")) return;
+    }
+
+    PackageConfig config;
+    config.lazy_load = true;
+    config.enable_prefetch = true;
+    config.max_cache_size = 256 * 1024; // Smaller than the scenes, so each pass decodes them again
+    config.prefetch_bytes_per_second = 4 * 1024 * 1024; // Keep background decoding from competing with the game
+    {
+        Package pak(config);
+        if (!Succeeded(pak.Load("prefetch.pak"), "Load")) return;
+        // Scenes are always visited in the same order, so each one predicts the next
+        for (int pass = 0; pass < 4; ++pass) {
+            for (const auto& [name, data] : files) {
+                if (!CheckEntry(pak, name, data)) return;
+            }
+        }
+        PrefetchStats stats = pak.GetPrefetchStats();
+        std::cout << "Prefetched " << stats.issued << " entries, " << stats.hits << " used, "
+                  << stats.dropped << " dropped" << std::endl;
+        if (!Succeeded(pak.SavePrefetchModel("prefetch.model"), "SavePrefetchModel")) return;
+    }
+
+    // A new run predicts from its first access
+    Package pak(config);
+    if (!Succeeded(pak.Load("prefetch.pak"), "Load") || !Succeeded(pak.LoadPrefetchModel("prefetch.model"), "LoadPrefetchModel")) return;
+    for (const auto& [name, data] : files) {
+        if (!CheckEntry(pak, name, data)) return;
+    }
+    std::cout << "Round trip matches with a loaded model (" << pak.GetPrefetchStats().issued << " prefetched)" << std::endl;
+}
+
+// Example 27: Loading an entry together with everything it depends on
+void Example_Dependencies() {
+    std::cout << "\n=== Example 27: Dependencies ===" << std::endl;
+
+    std::vector<std::pair<std::string, ByteArray>> files = {
+        { "materials/stone.mat", MakeSample(4 * 1024, 900) },
+        { "textures/stone.dds", MakeSample(128 * 1024, 901) },
+        { "textures/stone_normal.dds", MakeSample(128 * 1024, 902) },
+        { "shaders/lit.shader", MakeSample(8 * 1024, 903) },
+    };
+    {
+        Package pak;
+        if (!Succeeded(pak.AddMultiple(files), "AddMultiple")) return;
+        if (!Succeeded(pak.SetDependencies("materials/stone.mat", { "textures/stone.dds", "textures/stone_normal.dds", "shaders/lit.shader" }), "SetDependencies")) return;
+        if (!Succeeded(pak.SetDependencies("textures/stone_normal.dds", { "textures/stone.dds" }), "SetDependencies")) return;
+        if (!Succeeded(pak.Save("deps.pak"), "Save")) return;
+    }
+
+    PackageConfig config;
+    config.lazy_load = true;
+    Package pak(config);
+    if (!Succeeded(pak.Load("deps.pak"), "Load")) return;
+    std::cout << "stone.mat depends on " << pak.GetDependencies("materials/stone.mat").size() << " entries" << std::endl;
+
+    auto closure = pak.GetWithDependencies("materials/stone.mat");
+    if (!closure) {
+        std::cout << "GetWithDependencies failed" << std::endl;
+        ++g_failures;
+        return;
+    }
+    for (const auto& [name, data] : *closure) {
+        auto it = std::find_if(files.begin(), files.end(), [&](const auto& file) { return file.first == name; });
+        if (it == files.end() || it->second != data) {
+            std::cout << "  " << name << ": MISMATCH" << std::endl;
+            ++g_failures;
+            return;
+        }
+    }
+    std::cout << "Loaded " << closure->size() << " entries with their dependencies" << std::endl;
+
+    // Prefetching the closure fills the cache so the individual reads that follow are hits
+    pak.ClearCache();
+    if (!Succeeded(pak.PrefetchClosure("materials/stone.mat"), "PrefetchClosure")) return;
+    for (const auto& [name, data] : files) {
+        if (!CheckEntry(pak, name, data)) return;
+    }
+    std::cout << "Round trip matches after PrefetchClosure" << std::endl;
+}
+
+// Example 28: Bundles stored back to back and loaded in one read
+void Example_Bundles() {
+    std::cout << "\n=== Example 28: Bundles ===" << std::endl;
+
+    std::vector<std::pair<std::string, ByteArray>> files;
+    for (uint32_t i = 0; i < 12; ++i) files.emplace_back("level1/asset" + std::to_string(i), MakeSample(24 * 1024, 1000 + i));
+    std::vector<std::string> members;
+    for (size_t i = 0; i < files.size(); i += 2) members.push_back(files[i].first);
+    {
+        Package pak;
+        if (!Succeeded(pak.AddMultiple(files), "AddMultiple")) return;
+        if (!Succeeded(pak.DefineBundle("level1", members), "DefineBundle")) return;
+        if (!Succeeded(pak.Save("bundles.pak"), "Save")) return;
+    }
+
+    PackageConfig config;
+    config.lazy_load = true;
+    Package pak(config);
+    if (!Succeeded(pak.Load("bundles.pak"), "Load")) return;
+    for (const auto& bundle : pak.ListBundles()) {
+        std::cout << "Bundle " << bundle << ": " << pak.GetBundle(bundle).size() << " entries" << std::endl;
+    }
+
+    // One read brings the whole bundle into the cache, since Save stored it back to back
+    if (!Succeeded(pak.LoadBundle("level1"), "LoadBundle")) return;
+    std::cout << "Cached " << pak_utils::FormatSize(pak.GetCacheSize()) << " after LoadBundle" << std::endl;
+    for (const auto& [name, data] : files) {
+        if (!CheckEntry(pak, name, data)) return;
+    }
+    std::cout << "Round trip matches for bundled and loose entries" << std::endl;
+}
+
+// Example 29: Tiny entries kept inside the directory
+void Example_InlineEntries() {
+    std::cout << "\n=== Example 29: Inline Entries ===" << std::endl;
+
+    // Small configs and strings, as well as one entry too large to inline
+    std::vector<std::pair<std::string, ByteArray>> files;
+    for (uint32_t i = 0; i < 50; ++i) files.emplace_back("strings/" + std::to_string(i) + ".txt", MakeSample(8 + i * 4, 1100 + i));
+    files.emplace_back("strings/all.txt", MakeSample(64 * 1024, 1150));
+
+    for (size_t threshold : { size_t(0), PackageConfig::Default().inline_threshold }) {
+        PackageConfig config;
+        config.inline_threshold = threshold;
+        std::string path = "inline" + std::to_string(threshold) + ".pak";
+        {
+            Package pak(config);
+            if (!Succeeded(pak.AddMultiple(files), "AddMultiple") || !Succeeded(pak.Save(path), "Save")) return;
+        }
+
+        // Inlined entries arrive with the directory, so even a lazy load reads them without touching the file again
+        config.lazy_load = true;
+        Package pak(config);
+        if (!Succeeded(pak.Load(path), "Load")) return;
+        for (const auto& [name, data] : files) {
+            if (!CheckEntry(pak, name, data)) return;
+        }
+        std::cout << "inline_threshold " << threshold << ": " << pak_utils::FormatSize(std::filesystem::file_size(path))
+                  << " on disk, round trip matches" << std::endl;
+    }
+}
+
+// Example 30: Read-ahead for reads in file order
+void Example_ReadAhead() {
+    std::cout << "\n=== Example 30: Read-Ahead ===" << std::endl;
+
+    std::vector<std::pair<std::string, ByteArray>> files;
+    for (uint32_t i = 0; i < 64; ++i) files.emplace_back("frames/" + std::to_string(1000 + i), MakeSample(16 * 1024, 1200 + i));
+    {
+        Package pak;
+        if (!Succeeded(pak.AddMultiple(files), "AddMultiple") || !Succeeded(pak.Save("readahead.pak"), "Save")) return;
+    }
+
+    for (size_t window : { size_t(0), size_t(1024 * 1024) }) {
+        PackageConfig config;
+        config.lazy_load = true;
+        config.read_ahead_size = window;
+        Package pak(config);
+        if (!Succeeded(pak.Load("readahead.pak"), "Load")) return;
+
+        // Reading in List order follows the file, so the window grows and serves later entries from memory
+        for (const auto& name : pak.List()) {
+            auto it = std::find_if(files.begin(), files.end(), [&](const auto& file) { return file.first == name; });
+            if (it == files.end() || !CheckEntry(pak, name, it->second)) return;
+        }
+        std::cout << "read_ahead_size " << (window ? pak_utils::FormatSize(window) : "off") << ": round trip matches" << std::endl;
+    }
+}
+
+// Example 31: Warming and dropping the OS page cache
+void Example_PageCache() {
+    std::cout << "\n=== Example 31: Page Cache Control ===" << std::endl;
+
+    std::vector<std::pair<std::string, ByteArray>> files;
+    for (uint32_t i = 0; i < 16; ++i) files.emplace_back("videos/clip" + std::to_string(i), MakeSample(256 * 1024, 1300 + i));
+    {
+        Package pak;
+        if (!Succeeded(pak.AddMultiple(files), "AddMultiple") || !Succeeded(pak.Save("pagecache.pak"), "Save")) return;
+    }
+
+    PackageConfig config;
+    config.lazy_load = true;
+    config.max_cache_size = 0;
+    Package pak(config);
+    if (!Succeeded(pak.Load("pagecache.pak"), "Load")) return;
+
+    // Warm the first clips ahead of playback
+    if (!Succeeded(pak.WarmPageCache({ files[0].first, files[1].first }), "WarmPageCache")) return;
+    for (const auto& [name, data] : files) {
+        if (!CheckEntry(pak, name, data)) return;
+    }
+
+    // A one-off scan is done, so hand the pages back to the OS; reads still work, just from disk
+    if (!Succeeded(pak.DropPageCache(), "DropPageCache")) return;
+    for (const auto& [name, data] : files) {
+        if (!CheckEntry(pak, name, data)) return;
+    }
+    std::cout << "Round trip matches after warming and dropping pages" << std::endl;
+}
+
+// Example 32: Reading while another thread adds and removes entries
+void Example_ConcurrentEdits() {
+    std::cout << "\n=== Example 32: Concurrent Edits ===" << std::endl;
+
+    constexpr uint32_t COUNT = 32;
+    std::vector<ByteArray> v1, v2, extras;
+    for (uint32_t i = 0; i < COUNT; ++i) {
+        v1.push_back(MakeSample(8 * 1024, 1400 + i));
+        v2.push_back(MakeSample(12 * 1024, 1500 + i));
+        extras.push_back(MakeSample(4 * 1024, 1600 + i));
+    }
+    auto name_of = [](const char* prefix, uint32_t i) { return prefix + std::to_string(i); };
+
+    Package pak;
+    for (uint32_t i = 0; i < COUNT; ++i) {
+        if (!Succeeded(pak.Add(name_of("doc", i), v1[i]), "Add")) return;
+    }
+
+    // Readers see each entry before or after an edit, never a mix; removed entries are simply missing
+    std::atomic<bool> done{ false };
+    std::atomic<size_t> reads{ 0 }, torn{ 0 };
+    std::vector<std::thread> readers;
+    for (uint32_t t = 0; t < 4; ++t) {
+        readers.emplace_back([&, t] {
+            for (uint32_t i = t; !done; i = (i + 1) % COUNT) {
+                auto doc = pak.Get(name_of("doc", i));
+                if (!doc || (*doc != v1[i] && *doc != v2[i])) ++torn;
+                auto extra = pak.Get(name_of("extra", i));
+                if (extra && *extra != extras[i]) ++torn;
+                ++reads;
+            }
+        });
+    }
+
+    bool edited = true;
+    for (uint32_t i = 0; i < COUNT && edited; ++i) {
+        edited = Succeeded(pak.Add(name_of("doc", i), v2[i]), "Add") && Succeeded(pak.Add(name_of("extra", i), extras[i]), "Add");
+        if (edited && i % 2 == 1) edited = pak.Remove(name_of("extra", i));
+    }
+    done = true;
+    for (auto& reader : readers) reader.join();
+    std::cout << reads.load() << " reads during edits, " << torn.load() << " inconsistent" << std::endl;
+    if (!edited || torn != 0) {
+        ++g_failures;
+        return;
+    }
+
+    // The edited package saves and loads like any other
+    if (!Succeeded(pak.Save("edits.pak"), "Save")) return;
+    Package loaded;
+    if (!Succeeded(loaded.Load("edits.pak"), "Load")) return;
+    for (uint32_t i = 0; i < COUNT; ++i) {
+        if (!CheckEntry(loaded, name_of("doc", i), v2[i])) return;
+        if (i % 2 == 0 && !CheckEntry(loaded, name_of("extra", i), extras[i])) return;
+        if (i % 2 == 1 && loaded.Has(name_of("extra", i))) {
+            std::cout << "  " << name_of("extra", i) << ": still present" << std::endl;
+            ++g_failures;
+            return;
+        }
+    }
+    std::cout << "Round trip matches after concurrent edits" << std::endl;
+}
+
+// Example 33: Reloading a new version of the file under running readers
+void Example_HotReload() {
+    std::cout << "\n=== Example 33: Hot Reload ===" << std::endl;
+
+    constexpr uint32_t COUNT = 24;
+    std::vector<ByteArray> v1, v2, patches;
+    for (uint32_t i = 0; i < COUNT; ++i) {
+        v1.push_back(MakeSample(16 * 1024, 1700 + i));
+        v2.push_back(MakeSample(16 * 1024, 1800 + i));
+        patches.push_back(MakeSample(4 * 1024, 1900 + i));
+    }
+    auto name_of = [](uint32_t i) { return "assets/" + std::to_string(i); };
+    for (const auto& [path, versions] : { std::pair{ "reload1.pak", &v1 }, std::pair{ "reload2.pak", &v2 } }) {
+        Package pak;
+        for (uint32_t i = 0; i < COUNT; ++i) {
+            if (!Succeeded(pak.Add(name_of(i), (*versions)[i]), "Add")) return;
+        }
+        if (!Succeeded(pak.Save(path), "Save")) return;
+    }
+
+    PackageConfig config;
+    config.lazy_load = false; // Eager entries decode once, for whichever thread asks first
+    Package pak(config);
+    if (!Succeeded(pak.Load("reload1.pak"), "Load")) return;
+
+    // Readers keep going while the file is swapped under them and entries are patched in memory
+    std::atomic<bool> done{ false };
+    std::atomic<size_t> reads{ 0 }, torn{ 0 };
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (uint32_t i = t; !done; i = (i + 1) % COUNT) {
+                auto data = pak.Get(name_of(i));
+                if (!data || (*data != v1[i] && *data != v2[i] && *data != patches[i])) ++torn;
+                ++reads;
+            }
+        });
+    }
+    std::atomic<bool> patched{ true };
+    threads.emplace_back([&] {
+        for (uint32_t round = 0; round < 4 && !done; ++round) {
+            for (uint32_t i = round % 2; i < COUNT; i += 2) {
+                if (!pak.Add(name_of(i), patches[i])) patched = false;
+            }
+        }
+    });
+
+    bool reloaded = true;
+    for (int round = 0; (round < 20 || reads < 2000) && reloaded; ++round) {
+        reloaded = Succeeded(pak.Reload(round % 2 == 0 ? "reload2.pak" : "reload1.pak"), "Reload");
+    }
+    done = true;
+    for (auto& thread : threads) thread.join();
+    std::cout << reads.load() << " reads during reloads, " << torn.load() << " inconsistent" << std::endl;
+    if (!reloaded || !patched || torn != 0) {
+        ++g_failures;
+        return;
+    }
+
+    // Once the edits stop, the last reload decides what every read returns
+    if (!Succeeded(pak.Reload("reload2.pak"), "Reload")) return;
+    for (uint32_t i = 0; i < COUNT; ++i) {
+        if (!CheckEntry(pak, name_of(i), v2[i])) return;
+    }
+    std::cout << "Round trip matches the reloaded file" << std::endl;
+}
+
+// A minimal host job system: a fixed set of threads draining one queue
+class ExampleJobSystem : public JobSystem {
+public:
+    explicit ExampleJobSystem(unsigned threads) {
+        for (unsigned i = 0; i < threads; ++i) m_threads.emplace_back([this] { Run(); });
+    }
+
+    ~ExampleJobSystem() override {
+        {
+            std::lock_guard lock(m_mutex);
+            m_stop = true;
+        }
+        m_ready.notify_all();
+        for (auto& thread : m_threads) thread.join();
+    }
+
+    void Submit(std::function<void()> job) override {
+        {
+            std::lock_guard lock(m_mutex);
+            m_jobs.push_back(std::move(job));
+        }
+        ++m_submitted;
+        m_ready.notify_one();
+    }
+
+    unsigned Concurrency() const override { return static_cast<unsigned>(m_threads.size()); }
+    size_t Submitted() const { return m_submitted; }
+
+private:
+    void Run() {
+        for (;;) {
+            std::function<void()> job;
+            {
+                std::unique_lock lock(m_mutex);
+                m_ready.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+                if (m_jobs.empty()) return;
+                job = std::move(m_jobs.front());
+                m_jobs.pop_front();
+            }
+            job();
+        }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_ready;
+    std::deque<std::function<void()>> m_jobs;
+    std::vector<std::thread> m_threads;
+    std::atomic<size_t> m_submitted{ 0 };
+    bool m_stop{ false };
+};
+
+// Example 34: Running bulk work on the host's own job system
+void Example_JobSystem() {
+    std::cout << "\n=== Example 34: Host Job System ===" << std::endl;
+
+    std::vector<std::pair<std::string, ByteArray>> files;
+    for (uint32_t i = 0; i < 40; ++i) files.emplace_back("jobs/file" + std::to_string(i) + ".bin", MakeSample(48 * 1024, 2000 + i));
+
+    // Packages share it; each waits for its own jobs before it is destroyed
+    auto jobs = std::make_shared<ExampleJobSystem>(3);
+    PackageConfig config;
+    config.job_system = jobs;
+    {
+        Package pak(config);
+        if (!Succeeded(pak.AddMultiple(files), "AddMultiple") || !Succeeded(pak.Save("jobs.pak"), "Save")) return;
+    }
+
+    Package pak(config);
+    if (!Succeeded(pak.Load("jobs.pak"), "Load")) return;
+    if (!Succeeded(pak.VerifyAll(), "VerifyAll")) return;
+    if (!Succeeded(pak.ExtractAll("jobs_output"), "ExtractAll")) return;
+    std::cout << "Host job system ran " << jobs->Submitted() << " jobs" << std::endl;
+
+    for (const auto& [name, data] : files) {
+        if (!CheckExtracted(std::filesystem::path("jobs_output") / name, data)) return;
+    }
+    std::cout << "Extracted files match the originals" << std::endl;
+}
+
+// Example 35: Bounding the memory held between pipeline stages
+void Example_InflightLimit() {
+    std::cout << "\n=== Example 35: In-Flight Memory Limit ===" << std::endl;
+
+    // Many small entries plus one larger than the whole budget, which then runs alone
+    std::vector<std::pair<std::string, ByteArray>> files;
+    for (uint32_t i = 0; i < 200; ++i) files.emplace_back("stream/part" + std::to_string(i), MakeSample(16 * 1024, 2100 + i));
+    files.emplace_back("stream/large", MakeSample(2 * 1024 * 1024, 2300));
+
+    PackageConfig config;
+    config.max_inflight_bytes = 512 * 1024;
+    {
+        Package pak(config);
+        if (!Succeeded(pak.AddMultiple(files), "AddMultiple") || !Succeeded(pak.Save("inflight.pak"), "Save")) return;
+    }
+
+    Package pak(config);
+    if (!Succeeded(pak.Load("inflight.pak"), "Load")) return;
+    if (!Succeeded(pak.ExtractAll("inflight_output"), "ExtractAll")) return;
+    for (const auto& [name, data] : files) {
+        if (!CheckExtracted(std::filesystem::path("inflight_output") / name, data)) return;
+    }
+    std::cout << "Extracted " << files.size() << " files with at most " << pak_utils::FormatSize(config.max_inflight_bytes)
+              << " in flight, all match" << std::endl;
+}
+
 int main() {
     std::cout << "==================================" << std::endl;
     std::cout << "    RBPak Library Examples" << std::endl;
@@ -276,10 +1224,40 @@ int main() {
         Example_ErrorHandling();
         Example_CacheManagement();
         Example_OperatorOverload();
+        Example_GetInto();
+        Example_ParallelInflate();
+        Example_FastInflate();
+        Example_ThreadContexts();
+        Example_BufferPool();
+        Example_MemoryResource();
+        Example_ArenaCache();
+        Example_FrontCache();
+        Example_CompressedCache();
+        Example_DiskCache();
+        Example_SharedCache();
+        Example_Pinning();
+        Example_CacheResizing();
+        Example_MissRatioCurve();
+        Example_CacheManifest();
+        Example_Prefetching();
+        Example_Dependencies();
+        Example_Bundles();
+        Example_InlineEntries();
+        Example_ReadAhead();
+        Example_PageCache();
+        Example_ConcurrentEdits();
+        Example_HotReload();
+        Example_JobSystem();
+        Example_InflightLimit();
 
         // Uncomment if you have a test_data directory
         // Example_AddDirectory();
 
+        if (g_failures != 0) {
+            std::cerr << "Example checks that failed: " << g_failures << std::endl;
+            return 1;
+        }
+
         std::cout << "\n==================================" << std::endl;
         std::cout << "All examples completed!" << std::endl;
         std::cout << "==================================" << std::endl;
@@ -12,6 +12,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <memory_resource>
 #include <optional>
 #include <string>
 #include <vector>
@@ -74,6 +75,37 @@ namespace rbpak {
         explicit operator bool() const { return success; }
     };
 
+    enum class CacheStorage : uint8_t {
+        Heap = 0,  // Each cached entry is its own allocation from memory_resource
+        Arena = 1  // One preallocated max_cache_size region carved into slab size classes
+    };
+
+    // Eviction order for cached entries: Low goes first, High last; pinned entries are never evicted
+    enum class CachePriority : uint8_t {
+        Low = 0,
+        Normal = 1,
+        High = 2
+    };
+
+    enum class MemoryPressure : uint8_t {
+        None = 0,
+        Moderate = 1, // Caches shrink to half their capacity
+        Critical = 2  // Unpinned cache contents and idle buffers are released
+    };
+
+    using MemoryPressureCallback = std::function<void(MemoryPressure level)>;
+
+    // Runs the package's bulk work (Save, ExtractAll, AddDirectory, VerifyAll, prefetch). Hosts implement it to
+    // put that work on their own job system; by default the package starts work-stealing workers of its own.
+    class JobSystem {
+    public:
+        virtual ~JobSystem() = default;
+        // Runs job once, on any thread, possibly inline. Callers never wait for a job to start,
+        // but a package waits for its background jobs to finish before it is destroyed.
+        virtual void Submit(std::function<void()> job) = 0;
+        [[nodiscard]] virtual unsigned Concurrency() const = 0; // Jobs worth running at once
+    };
+
     struct PackageConfig {
         CompressionLevel compression{ CompressionLevel::Balanced };
         EncryptionMethod encryption{ EncryptionMethod::None };
@@ -82,6 +114,53 @@ namespace rbpak {
         bool verify_checksums{ true };
         bool lazy_load{ true };
         size_t max_cache_size{ 100 * 1024 * 1024 }; // 100MB default cache
+        size_t pinned_cache_size{ 32 * 1024 * 1024 }; // Budget for pinned entries, separate from max_cache_size
+        CacheStorage cache_storage{ CacheStorage::Heap };
+        bool cache_huge_pages{ false }; // Back the cache arena with huge/large pages when the OS allows
+        size_t compressed_cache_size{ 0 }; // Second tier holding stored (compressed) bytes, 0 disables
+        size_t front_cache_entries{ 0 }; // Per-thread slots for the hottest entries ahead of the shared cache, 0 disables
+        size_t parallel_threshold{ 16 * 1024 * 1024 }; // Entries this large are stored as blocks and inflated in parallel
+        size_t chunk_size{ 1024 * 1024 }; // Block size for chunked entries
+        size_t inline_threshold{ 256 }; // Entries whose stored bytes fit are kept in the directory itself, 0 disables
+        size_t read_ahead_size{ 8 * 1024 * 1024 }; // Largest read-ahead window for reads in file order, 0 disables
+        uint32_t worker_threads{ 0 }; // 0 = hardware concurrency
+        std::vector<uint32_t> worker_cpus; // CPUs the workers are pinned to in turn; empty leaves placement to the OS
+        std::shared_ptr<JobSystem> job_system; // Replaces the package's own workers; nullptr = built in
+        size_t buffer_pool_size{ 64 * 1024 * 1024 }; // Idle staging buffers kept for reuse, 0 disables pooling
+        // Memory that Save, ExtractAll and AddDirectory may hold between their stages, shared by all of them;
+        // an entry larger than this runs alone. 0 = unbounded
+        size_t max_inflight_bytes{ 256 * 1024 * 1024 };
+        // Decoded copies of hot entries kept on disk across runs, keyed by package identity; empty disables.
+        // Encrypted entries are never written here. Loading a package removes copies left by older versions of that file.
+        std::string disk_cache_directory;
+        uint32_t disk_cache_min_hits{ 2 }; // Decodes of an entry before it is written to the disk cache
+        size_t disk_cache_min_size{ 64 * 1024 }; // Smaller entries decode faster than they map
+        size_t disk_cache_max_size{ 1024 * 1024 * 1024 }; // Oldest copies are deleted past this, 0 = unbounded
+        // Host-wide segment (POSIX shm name) where processes share decoded entries; empty disables.
+        // The segment outlives the processes; its first creator decides the size, and one a crashed creator left
+        // unfinished is rebuilt by the next process to attach. Encrypted entries are never shared.
+        // Entries it holds are not also kept in the process's own cache; each read still copies them out.
+        std::string shared_cache_name;
+        size_t shared_cache_size{ 256 * 1024 * 1024 };
+        // Shrink caches on OS memory-pressure signals (Linux PSI, Windows low-memory notification)
+        bool monitor_memory_pressure{ false };
+        MemoryPressureCallback memory_pressure_callback; // Called after the package reacts; may run on the monitor thread
+        // Sample cache accesses to estimate the hit ratio at other capacities (see GetMissRatioCurve)
+        bool track_miss_ratio{ false };
+        double miss_ratio_sample_rate{ 0.1 }; // Packages hold thousands of entries, not millions; lower rates get noisy
+        // With tracking on, resize the cache to the smallest capacity predicted to reach this ratio; 0 disables
+        double target_hit_ratio{ 0.0 };
+        size_t min_auto_cache_size{ 4 * 1024 * 1024 };
+        size_t max_auto_cache_size{ 0 }; // 0 = max_cache_size
+        // Learn which entries follow each other and prefetch likely successors in the background (lazy_load only)
+        bool enable_prefetch{ false };
+        uint32_t prefetch_depth{ 2 }; // Successors queued per access
+        double prefetch_min_confidence{ 0.25 }; // Share of observed transitions a successor needs
+        size_t prefetch_memory_budget{ 32 * 1024 * 1024 }; // Prefetched bytes not yet requested
+        size_t prefetch_bytes_per_second{ 0 }; // Decoded bytes per second, 0 = unlimited; throttling starts one timer thread
+        // Backs entry data, directory strings, cache storage and staging buffers; nullptr = default resource.
+        // Must outlive the package.
+        std::pmr::memory_resource* memory_resource{ nullptr };
 
         static PackageConfig Default() {
             return PackageConfig{};
@@ -127,6 +206,30 @@ namespace rbpak {
         }
     };
 
+    struct BufferPoolStats {
+        size_t acquisitions{ 0 };
+        size_t reuses{ 0 };
+        size_t allocations{ 0 };
+        size_t discards{ 0 };
+        size_t retained_bytes{ 0 };
+        size_t peak_retained_bytes{ 0 };
+        size_t retained_limit{ 0 };
+    };
+
+    struct MissRatioPoint {
+        size_t capacity;  // Cache size in bytes
+        double hit_ratio; // Predicted fraction of accesses served from a cache this large
+    };
+
+    struct PrefetchStats {
+        size_t issued{ 0 };   // Entries prefetched into the cache
+        size_t hits{ 0 };     // Prefetched entries later requested
+        size_t wasted{ 0 };   // Prefetched entries evicted or invalidated before use
+        size_t dropped{ 0 };  // Predictions skipped for queue, memory or bandwidth limits
+        size_t outstanding_bytes{ 0 };
+    };
+
+    // Bulk operations may call it from worker threads, one call at a time
     using ProgressCallback = std::function<void(size_t current, size_t total, std::string_view filename)>;
 
     class Package {
@@ -139,6 +242,7 @@ namespace rbpak {
         Package(Package&&) noexcept;
         Package& operator=(Package&&) noexcept;
 
+        // Edits may run while other threads read: each read sees the package as it was before or after an edit
         [[nodiscard]] PackageResult Add(std::string_view name, std::span<const uint8_t> data);
         [[nodiscard]] PackageResult Add(std::string_view name, const ByteArray& data);
         [[nodiscard]] PackageResult AddFromFile(std::string_view name, std::string_view filepath);
@@ -149,16 +253,43 @@ namespace rbpak {
             ProgressCallback callback = nullptr);
 
         [[nodiscard]] std::optional<ByteArray> Get(std::string_view name);
+        [[nodiscard]] std::optional<size_t> GetSize(std::string_view name) const;
+        // Decodes straight into dest (at least GetSize bytes); only inserts into the cache when asked
+        [[nodiscard]] PackageResult GetInto(std::string_view name, std::span<uint8_t> dest, bool cache = false);
         [[nodiscard]] PackageResult Extract(std::string_view name, std::string_view output_path);
         [[nodiscard]] PackageResult ExtractAll(std::string_view output_directory,
             ProgressCallback callback = nullptr);
 
+        // Decodes every entry and checks its CRC, whether or not verify_checksums is set
+        [[nodiscard]] PackageResult VerifyAll(ProgressCallback callback = nullptr);
+
         [[nodiscard]] bool Remove(std::string_view name);
         [[nodiscard]] bool Has(std::string_view name) const;
         [[nodiscard]] std::optional<FileInfo> GetFileInfo(std::string_view name) const;
 
+        // Links stored by Save; loading an entry with its dependencies reads the transitive closure at once
+        [[nodiscard]] PackageResult SetDependencies(std::string_view name, const std::vector<std::string>& dependencies);
+        [[nodiscard]] std::vector<std::string> GetDependencies(std::string_view name) const;
+        [[nodiscard]] std::optional<std::vector<std::pair<std::string, ByteArray>>> GetWithDependencies(std::string_view name);
+        [[nodiscard]] PackageResult PrefetchClosure(std::string_view name);
+
+        // Named sets of entries that Save stores back to back; LoadBundle brings a whole set into the cache
+        [[nodiscard]] PackageResult DefineBundle(std::string_view bundle, const std::vector<std::string>& members);
+        [[nodiscard]] std::vector<std::string> ListBundles() const;
+        [[nodiscard]] std::vector<std::string> GetBundle(std::string_view bundle) const;
+        [[nodiscard]] PackageResult LoadBundle(std::string_view bundle);
+
+        // OS page cache control over the named entries' bytes in the backing file, all of it when none are named.
+        // Warming asks the OS to start the reads (reads the bytes itself where it cannot); dropping releases
+        // pages after a one-off scan.
+        [[nodiscard]] PackageResult WarmPageCache(const std::vector<std::string>& names = {});
+        [[nodiscard]] PackageResult DropPageCache(const std::vector<std::string>& names = {});
+
         [[nodiscard]] PackageResult Save(std::string_view filepath, ProgressCallback callback = nullptr);
         [[nodiscard]] PackageResult Load(std::string_view filepath);
+        // Switches to a new version of the loaded package while readers keep going; entries whose CRC and
+        // size did not change stay cached. Fails, leaving the package as it was, if the file's flags differ.
+        [[nodiscard]] PackageResult Reload(std::string_view filepath);
         void Clear() noexcept;
 
         [[nodiscard]] std::vector<std::string> List() const;
@@ -169,7 +300,33 @@ namespace rbpak {
         [[nodiscard]] float GetCompressionRatio() const noexcept;
 
         void ClearCache() noexcept;
-        [[nodiscard]] size_t GetCacheSize() const noexcept;
+        [[nodiscard]] size_t GetCacheSize() const noexcept; // Includes per-entry bookkeeping
+        [[nodiscard]] size_t GetCompressedCacheSize() const noexcept;
+        [[nodiscard]] bool HasSharedCache() const noexcept; // false when the platform or segment is unavailable
+
+        // Records cached entry names, most valuable first, so a later run can warm up with them
+        [[nodiscard]] PackageResult SaveCacheManifest(std::string_view path) const;
+        // Loads manifest entries up to budget bytes (0 = cache capacity) on a background thread
+        [[nodiscard]] PackageResult WarmFromManifest(std::string_view path, size_t budget = 0);
+        void WaitForWarmup();
+
+        // Successor statistics learned by enable_prefetch, so a new run can prefetch from the first access
+        [[nodiscard]] PackageResult SavePrefetchModel(std::string_view path) const;
+        [[nodiscard]] PackageResult LoadPrefetchModel(std::string_view path);
+        [[nodiscard]] PrefetchStats GetPrefetchStats() const;
+
+        // Keeps an entry decoded in the cache, counted against pinned_cache_size, until Unpin
+        [[nodiscard]] PackageResult Pin(std::string_view name);
+        bool Unpin(std::string_view name);
+        bool SetCachePriority(std::string_view name, CachePriority priority);
+        [[nodiscard]] size_t GetPinnedSize() const noexcept;
+
+        void SetCacheCapacity(size_t bytes);
+        [[nodiscard]] size_t GetCacheCapacity() const noexcept;
+        void OnMemoryPressure(MemoryPressure level); // Also driven automatically by monitor_memory_pressure
+        [[nodiscard]] MemoryPressure GetMemoryPressure() const noexcept;
+        [[nodiscard]] std::vector<MissRatioPoint> GetMissRatioCurve() const; // Empty unless track_miss_ratio
+        [[nodiscard]] BufferPoolStats GetBufferPoolStats() const;
 
         void PrintStatistics() const;
         [[nodiscard]] const PackageConfig& GetConfig() const noexcept;
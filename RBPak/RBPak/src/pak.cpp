@@ -16,285 +16,2592 @@
 #include <sstream>
 #include <filesystem>
 #include <unordered_map>
+#include <unordered_set>
 #include <cstring>
 #include <list>
+#include <array>
+#include <memory_resource>
 #include <mutex>
+#include <condition_variable>
+#include <deque>
 #include <atomic>
+#include <thread>
+#include <bit>
+#include <utility>
+#include <chrono>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <poll.h>
+#include <sys/file.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#endif
 
 namespace fs = std::filesystem;
 
 namespace rbpak {
-    template<typename Key, typename Value>
+    using Blob = std::pmr::vector<uint8_t>;
+    using BlobPtr = std::shared_ptr<const Blob>;
+
+    struct StringHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view value) const noexcept { return std::hash<std::string_view>{}(value); }
+    };
+
+    template<typename Value>
+    using StringMap = std::pmr::unordered_map<std::pmr::string, Value, StringHash, std::equal_to<>>;
+
+    BlobPtr MakeBlob(std::pmr::memory_resource* resource, const uint8_t* data, size_t size) {
+        return std::allocate_shared<Blob>(std::pmr::polymorphic_allocator<Blob>(resource), data, data + size);
+    }
+
+    // Keys are owned by the list nodes; the index refers to them by view. Each item sits in the list of its
+    // class: evictable classes are drained lowest priority first, pinned items only leave when erased or moved.
+    template<typename Value>
     class LRUCache {
+    public:
+        static constexpr size_t PINNED = 3; // Classes below follow CachePriority
+
     private:
+        static constexpr size_t CLASS_COUNT = PINNED + 1;
+
+        struct Item {
+            std::pmr::string key;
+            Value value;
+            size_t size;
+            size_t cls;
+        };
+        using ItemList = std::pmr::list<Item>;
+
         size_t m_capacity;
+        size_t m_pinned_capacity;
         size_t m_current_size{ 0 };
-        std::list<std::pair<Key, Value>> m_items;
-        std::unordered_map<Key, typename std::list<std::pair<Key, Value>>::iterator> m_map;
+        size_t m_pinned_size{ 0 };
+        std::pmr::memory_resource* m_resource;
+        std::array<ItemList, CLASS_COUNT> m_items;
+        std::pmr::unordered_map<std::string_view, typename ItemList::iterator> m_map;
         mutable std::mutex m_mutex;
 
+        size_t& SizeOf(size_t cls) { return cls == PINNED ? m_pinned_size : m_current_size; }
+
+        void EraseLocked(typename ItemList::iterator item) {
+            SizeOf(item->cls) -= item->size;
+            m_map.erase(item->key);
+            m_items[item->cls].erase(item);
+        }
+
+        bool EvictLocked() {
+            for (size_t cls = 0; cls < PINNED; ++cls) {
+                if (!m_items[cls].empty()) {
+                    EraseLocked(std::prev(m_items[cls].end()));
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool FitsLocked(size_t cls, size_t size) {
+            if (cls == PINNED) return m_pinned_size + size <= m_pinned_capacity;
+            if (size > m_capacity) return false;
+            while (m_current_size + size > m_capacity && EvictLocked()) {}
+            return true;
+        }
+
+        void Touch(typename ItemList::iterator item) {
+            m_items[item->cls].splice(m_items[item->cls].begin(), m_items[item->cls], item);
+        }
+
     public:
-        explicit LRUCache(size_t capacity) : m_capacity(capacity) {}
+        LRUCache(size_t capacity, std::pmr::memory_resource* resource, size_t pinned_capacity = 0)
+            : m_capacity(capacity), m_pinned_capacity(pinned_capacity), m_resource(resource),
+            m_items{ ItemList(resource), ItemList(resource), ItemList(resource), ItemList(resource) }, m_map(resource) {}
 
-        std::optional<Value> Get(const Key& key) {
+        std::optional<Value> Get(std::string_view key) {
             std::lock_guard lock(m_mutex);
             auto it = m_map.find(key);
             if (it == m_map.end()) return std::nullopt;
-            m_items.splice(m_items.begin(), m_items, it->second);
-            return it->second->second;
+            Touch(it->second);
+            return it->second->value;
         }
 
-        void Put(const Key& key, Value value, size_t size) {
+        // make() builds the value under the lock; if the backing resource runs out, LRU items are evicted and it retries.
+        // The key and the list and index nodes are charged along with size, since they come out of the same resource.
+        template<typename Make>
+        Value Put(std::string_view key, size_t size, Make&& make, size_t cls = 1) {
             std::lock_guard lock(m_mutex);
             auto it = m_map.find(key);
-            if (it != m_map.end()) {
-                m_items.erase(it->second);
-                m_map.erase(it);
-            }
-            while (m_current_size + size > m_capacity && !m_items.empty()) {
-                m_map.erase(m_items.back().first);
-                m_items.pop_back();
+            if (it != m_map.end()) EraseLocked(it->second);
+            size += key.size() + ITEM_OVERHEAD;
+            if (!FitsLocked(cls, size)) return Value{};
+            ItemList& items = m_items[cls];
+            for (;;) {
+                try {
+                    items.push_front(Item{ std::pmr::string(key, m_resource), make(), size, cls });
+                    try {
+                        m_map.emplace(items.front().key, items.begin());
+                    }
+                    catch (...) {
+                        items.pop_front();
+                        throw;
+                    }
+                    break;
+                }
+                catch (const std::bad_alloc&) {
+                    if (!EvictLocked()) return Value{};
+                }
             }
-            if (size <= m_capacity) {
-                m_items.emplace_front(key, std::move(value));
-                m_map[key] = m_items.begin();
-                m_current_size += size;
+            SizeOf(cls) += size;
+            return items.front().value;
+        }
+
+        // Moves a cached item to another class; fails if it is absent or the pinned budget is exhausted
+        bool Move(std::string_view key, size_t cls) {
+            std::lock_guard lock(m_mutex);
+            auto it = m_map.find(key);
+            if (it == m_map.end()) return false;
+            auto item = it->second;
+            if (item->cls == cls) return true;
+            SizeOf(item->cls) -= item->size;
+            if (!FitsLocked(cls, item->size)) {
+                SizeOf(item->cls) += item->size;
+                return false;
             }
+            m_items[cls].splice(m_items[cls].begin(), m_items[item->cls], item);
+            item->cls = cls;
+            SizeOf(cls) += item->size;
+            return true;
+        }
+
+        bool Erase(std::string_view key) {
+            std::lock_guard lock(m_mutex);
+            auto it = m_map.find(key);
+            if (it == m_map.end()) return false;
+            EraseLocked(it->second);
+            return true;
+        }
+
+        // Hands the cached value to reader under the lock, avoiding a copy
+        template<typename Reader>
+        bool Read(std::string_view key, Reader&& reader) {
+            std::lock_guard lock(m_mutex);
+            auto it = m_map.find(key);
+            if (it == m_map.end()) return false;
+            Touch(it->second);
+            reader(it->second->value);
+            return true;
         }
 
         void Clear() {
             std::lock_guard lock(m_mutex);
-            m_items.clear();
             m_map.clear();
+            for (auto& items : m_items) items.clear();
             m_current_size = 0;
+            m_pinned_size = 0;
         }
 
         size_t Size() const {
             std::lock_guard lock(m_mutex);
-            return m_current_size;
+            return m_current_size + m_pinned_size;
         }
-    };
 
-    struct Entry {
-        std::string name;
-        std::string stored_name;
-        uint32_t offset{ 0 };
-        uint32_t compressed_size{ 0 };
-        uint32_t uncompressed_size{ 0 };
-        uint32_t crc32{ 0 };
-        bool is_encrypted{ false };
-        bool is_loaded{ false };
-        ByteArray data;
-    };
+        size_t PinnedSize() const {
+            std::lock_guard lock(m_mutex);
+            return m_pinned_size;
+        }
 
-    class Cipher {
-    public:
-        explicit Cipher(std::string_view key) {
-            if (key.empty()) {
-                m_key = { 0x52, 0x42, 0x50, 0x6B };
-            }
-            else {
-                DeriveKey(key);
+        // Trims in batches, dropping the lock in between so readers are not stalled behind a large shrink
+        void SetCapacity(size_t capacity) {
+            for (bool done = false; !done;) {
+                std::lock_guard lock(m_mutex);
+                m_capacity = capacity;
+                for (size_t i = 0; i < EVICTION_BATCH && m_current_size > m_capacity; ++i) EvictLocked();
+                done = m_current_size <= m_capacity;
             }
         }
 
-        void Encrypt(uint8_t* data, size_t size) const {
-            if (m_key.empty() || !data) return;
-            for (size_t i = 0; i < size; ++i) {
-                data[i] ^= m_key[i % m_key.size()];
-            }
+        size_t Capacity() const {
+            std::lock_guard lock(m_mutex);
+            return m_capacity;
+        }
+
+        bool Contains(std::string_view key) const {
+            std::lock_guard lock(m_mutex);
+            return m_map.find(key) != m_map.end();
         }
 
-        void Decrypt(uint8_t* data, size_t size) const {
-            Encrypt(data, size);
+        // Most valuable first: pinned, then each priority class from High down, most recently used first
+        std::vector<std::string> Keys() const {
+            std::lock_guard lock(m_mutex);
+            std::vector<std::string> keys;
+            keys.reserve(m_map.size());
+            for (size_t cls = CLASS_COUNT; cls-- > 0;) {
+                for (const auto& item : m_items[cls]) keys.emplace_back(item.key);
+            }
+            return keys;
         }
 
     private:
-        void DeriveKey(std::string_view input) {
-            m_key.clear();
-            m_key.reserve(32);
-            std::string seed = std::string(input) + "RBPak_Salt_2025";
-            for (size_t i = 0; i < 32; ++i) {
-                uint32_t hash = 2166136261u;
-                for (char c : seed) {
-                    hash ^= static_cast<uint32_t>(static_cast<uint8_t>(c));
-                    hash *= 16777619u;
-                }
-                m_key.push_back(static_cast<uint8_t>(hash & 0xFF));
-                seed += std::to_string(hash);
-            }
+        static constexpr size_t EVICTION_BATCH = 64;
+        static constexpr size_t ITEM_OVERHEAD = sizeof(Item) + 6 * sizeof(void*); // List and index nodes, bucket slot
+    };
+
+    // Direct-mapped handles to recently used blobs, owned by a single thread. Slots are only valid for the
+    // package's front epoch they were filled in; the lock is uncontended except when the package goes away.
+    class FrontCache {
+    public:
+        explicit FrontCache(size_t slots) : m_slots(std::bit_ceil(std::max<size_t>(slots, 1))) {}
+
+        template<typename Reader>
+        bool Read(std::string_view key, uint64_t generation, Reader&& reader) {
+            std::lock_guard lock(m_mutex);
+            Slot& slot = m_slots[Index(key)];
+            if (!slot.blob || slot.generation != generation || slot.key != key) return false;
+            reader(*slot.blob);
+            return true;
         }
-        ByteArray m_key;
+
+        void Put(std::string_view key, BlobPtr blob, uint64_t generation) {
+            if (!blob) return;
+            std::lock_guard lock(m_mutex);
+            Slot& slot = m_slots[Index(key)];
+            slot.key = key;
+            slot.blob = std::move(blob);
+            slot.generation = generation;
+        }
+
+        void Clear() {
+            std::lock_guard lock(m_mutex);
+            for (auto& slot : m_slots) slot = Slot{};
+        }
+
+        // Called by the owning package on destruction so no handle outlives its memory resource
+        void Release() {
+            std::lock_guard lock(m_mutex);
+            for (auto& slot : m_slots) slot = Slot{};
+            m_orphaned = true;
+        }
+
+        bool IsOrphaned() {
+            std::lock_guard lock(m_mutex);
+            return m_orphaned;
+        }
+
+    private:
+        struct Slot {
+            std::string key;
+            BlobPtr blob;
+            uint64_t generation{ 0 };
+        };
+
+        size_t Index(std::string_view key) const { return std::hash<std::string_view>{}(key) & (m_slots.size() - 1); }
+
+        std::vector<Slot> m_slots;
+        bool m_orphaned{ false };
+        std::mutex m_mutex;
     };
 
-    namespace compression {
-        PackageResult Compress(const uint8_t* input, size_t input_size, ByteArray& output, CompressionLevel level) {
-            if (!input || input_size == 0) {
-                return PackageResult::Failure(PackageError::InvalidParameter, "Empty input");
-            }
-            if (level == CompressionLevel::None) {
-                output.assign(input, input + input_size);
-                return PackageResult::Success();
-            }
-            uLongf bound = compressBound(static_cast<uLong>(input_size));
-            output.resize(bound);
-            int result = compress2(output.data(), &bound, input, static_cast<uLong>(input_size), static_cast<int>(level));
-            if (result != Z_OK) {
-                return PackageResult::Failure(PackageError::CompressionFailed, "zlib error: " + std::to_string(result));
-            }
-            output.resize(bound);
-            return PackageResult::Success();
+    // Online miss-ratio curve estimate using spatial sampling (SHARDS): only keys whose hash falls under the
+    // sampling threshold are tracked, and their byte-weighted reuse distances are scaled up by 1/rate. Reuse
+    // distances come from a Fenwick tree over access timestamps, renumbered when the clock runs out. Hit counts
+    // are corrected by the gap between expected and actual sampled accesses (SHARDS-adj), which otherwise
+    // skews the curve when a few very hot keys happen to fall in or out of the sample.
+    class MissRatioCurve {
+    public:
+        static constexpr uint32_t MODULUS = 1u << 24;
+        static constexpr size_t BUCKETS = 128; // Two per power of two of reuse distance
+
+        MissRatioCurve(double sample_rate, size_t max_tracked)
+            : m_threshold(static_cast<uint32_t>(std::clamp(sample_rate, 1.0 / MODULUS, 1.0) * MODULUS)),
+            m_max_tracked(std::max<size_t>(max_tracked, 16)),
+            m_tree(2 * m_max_tracked + 1), m_owner(2 * m_max_tracked + 1) {}
+
+        // Counts every access, sampled or not
+        bool Sampled(uint32_t key) {
+            m_references.fetch_add(1, std::memory_order_relaxed);
+            return key % MODULUS < m_threshold;
         }
 
-        PackageResult Decompress(const uint8_t* input, size_t input_size, ByteArray& output, size_t expected) {
-            if (!input || input_size == 0) {
-                return PackageResult::Failure(PackageError::InvalidParameter, "Empty compressed data");
+        // Returns true every RETUNE_INTERVAL sampled accesses, when a capacity decision is worth revisiting
+        bool Record(uint32_t key, size_t size) {
+            std::lock_guard lock(m_mutex);
+            if (key == 0) key = 1; // 0 marks free stamps
+            ++m_accesses;
+            auto it = m_tracked.find(key);
+            if (it != m_tracked.end()) {
+                uint64_t distance = m_total - Prefix(it->second.stamp);
+                Add(it->second.stamp, 0 - uint64_t(it->second.size));
+                m_owner[it->second.stamp] = 0;
+                uint64_t scaled = distance * MODULUS / m_threshold + size;
+                ++m_histogram[Bucket(scaled)];
             }
-            if (expected == 0 || expected > 1024ULL * 1024 * 1024) {
-                return PackageResult::Failure(PackageError::InvalidParameter, "Invalid size");
+            else {
+                it = m_tracked.emplace(key, Tracked{}).first;
             }
-            output.resize(expected);
-            uLongf size = static_cast<uLongf>(expected);
-            int result = uncompress(output.data(), &size, input, static_cast<uLong>(input_size));
-            if (result != Z_OK) {
-                return PackageResult::Failure(PackageError::DecompressionFailed, "zlib error: " + std::to_string(result));
+            if (m_clock == m_tree.size()) Compact();
+            it->second = Tracked{ m_clock, size };
+            Add(m_clock, size);
+            m_owner[m_clock++] = key;
+            if (m_tracked.size() > m_max_tracked) EvictOldest();
+
+            // Halve the history regularly so the curve follows the current workload
+            if (m_accesses >= DECAY_INTERVAL) {
+                m_accesses /= 2;
+                m_references.fetch_sub(m_references.load(std::memory_order_relaxed) / 2, std::memory_order_relaxed);
+                for (auto& count : m_histogram) count /= 2;
             }
-            output.resize(size);
-            return PackageResult::Success();
+            return ++m_since_retune % RETUNE_INTERVAL == 0;
         }
-    }
 
-    namespace hash {
-        uint32_t MurmurHash3(const void* key, size_t len, uint32_t seed = 0x52425061) {
-            if (!key || len == 0) return seed;
-            const uint8_t* data = static_cast<const uint8_t*>(key);
-            const int nblocks = static_cast<int>(len / 4);
-            uint32_t h1 = seed;
-            const uint32_t c1 = 0xcc9e2d51;
-            const uint32_t c2 = 0x1b873593;
-            const uint32_t* blocks = reinterpret_cast<const uint32_t*>(data + nblocks * 4);
-            for (int i = -nblocks; i; i++) {
-                uint32_t k1 = blocks[i];
-                k1 *= c1;
-                k1 = (k1 << 15) | (k1 >> 17);
-                k1 *= c2;
-                h1 ^= k1;
-                h1 = (h1 << 13) | (h1 >> 19);
-                h1 = h1 * 5 + 0xe6546b64;
-            }
-            const uint8_t* tail = data + nblocks * 4;
-            uint32_t k1 = 0;
-            switch (len & 3) {
-            case 3: k1 ^= tail[2] << 16; [[fallthrough]];
-            case 2: k1 ^= tail[1] << 8; [[fallthrough]];
-            case 1: k1 ^= tail[0];
-                k1 *= c1;
-                k1 = (k1 << 15) | (k1 >> 17);
-                k1 *= c2;
-                h1 ^= k1;
-            }
-            h1 ^= static_cast<uint32_t>(len);
-            h1 ^= h1 >> 16;
-            h1 *= 0x85ebca6b;
-            h1 ^= h1 >> 13;
-            h1 *= 0xc2b2ae35;
-            h1 ^= h1 >> 16;
-            return h1;
+        double HitRatio(size_t capacity) const {
+            std::lock_guard lock(m_mutex);
+            if (m_accesses == 0) return 0.0;
+            uint64_t hits = 0;
+            for (size_t b = 0; b < BUCKETS && UpperBound(b) <= capacity; ++b) hits += m_histogram[b];
+            return Ratio(hits);
         }
 
-        std::string Obfuscate(std::string_view name) {
-            uint32_t hash = MurmurHash3(name.data(), name.size());
-            return "rbp_" + std::to_string(hash) + ".dat";
+        uint64_t Accesses() const {
+            std::lock_guard lock(m_mutex);
+            return m_accesses;
         }
-    }
 
-    class IOHelper {
-    public:
-        template<typename T>
-        static bool Write(std::ostream& stream, const T& value) {
-            return stream.write(reinterpret_cast<const char*>(&value), sizeof(T)).good();
+        std::vector<MissRatioPoint> Curve() const {
+            std::lock_guard lock(m_mutex);
+            std::vector<MissRatioPoint> points;
+            if (m_accesses == 0) return points;
+            size_t last = BUCKETS;
+            while (last > 0 && m_histogram[last - 1] == 0) --last;
+            uint64_t hits = 0;
+            for (size_t b = 0; b < last; ++b) {
+                hits += m_histogram[b];
+                if (hits == 0) continue;
+                points.push_back({ static_cast<size_t>(std::min<uint64_t>(UpperBound(b), SIZE_MAX)), Ratio(hits) });
+            }
+            return points;
         }
 
-        template<typename T>
-        static bool Read(std::istream& stream, T& value) {
-            return stream.read(reinterpret_cast<char*>(&value), sizeof(T)).good();
+        // Smallest bucket boundary within [low, high] predicted to reach target, or high
+        size_t CapacityFor(double target, size_t low, size_t high) const {
+            std::lock_guard lock(m_mutex);
+            uint64_t hits = 0;
+            for (size_t b = 0; b < BUCKETS; ++b) {
+                hits += m_histogram[b];
+                uint64_t bound = UpperBound(b);
+                if (bound >= high) break;
+                if (bound >= low && Ratio(hits) >= target) return static_cast<size_t>(bound);
+            }
+            return high;
         }
 
-        static bool WriteString(std::ostream& stream, std::string_view str) {
-            if (str.size() > UINT16_MAX) return false;
-            uint16_t length = static_cast<uint16_t>(str.length());
-            if (!Write(stream, length)) return false;
-            return stream.write(str.data(), length).good();
+    private:
+        static constexpr uint64_t DECAY_INTERVAL = 1u << 20;
+        static constexpr uint64_t RETUNE_INTERVAL = 4096;
+
+        struct Tracked {
+            size_t stamp{ 0 };
+            size_t size{ 0 };
+        };
+
+        double Ratio(uint64_t hits) const {
+            double expected = static_cast<double>(m_references.load(std::memory_order_relaxed)) * m_threshold / MODULUS;
+            if (expected < 1.0) return 0.0;
+            double adjusted = static_cast<double>(hits) + (expected - static_cast<double>(m_accesses));
+            return std::clamp(adjusted / expected, 0.0, 1.0);
         }
 
-        static bool ReadString(std::istream& stream, std::string& str) {
-            uint16_t length;
-            if (!Read(stream, length)) return false;
-            if (length > 8192) return false;
-            str.resize(length);
-            return stream.read(str.data(), length).good();
+        static size_t Bucket(uint64_t distance) {
+            if (distance < 2) return 0;
+            unsigned exponent = std::bit_width(distance) - 1;
+            return std::min<size_t>(2 * exponent + ((distance >> (exponent - 1)) & 1), BUCKETS - 1);
         }
-    };
 
-    class Package::Impl {
-    private:
-        static constexpr uint32_t SIGNATURE = 0x6B506252;
-        static constexpr uint32_t VERSION = 0x00020000;
+        static uint64_t UpperBound(size_t bucket) {
+            unsigned exponent = static_cast<unsigned>(bucket / 2);
+            if (exponent >= 63) return UINT64_MAX;
+            return bucket % 2 ? uint64_t(1) << (exponent + 1) : (uint64_t(3) << exponent) / 2;
+        }
 
-        PackageConfig m_config;
-        std::unordered_map<std::string, std::unique_ptr<Entry>> m_entries;
-        std::string m_filepath;
-        mutable std::ifstream m_reader;
-        std::unique_ptr<Cipher> m_cipher;
-        LRUCache<std::string, ByteArray> m_cache;
-        mutable std::atomic<PackageError> m_last_error{ PackageError::None };
+        void Add(size_t stamp, uint64_t delta) {
+            m_total += delta;
+            for (; stamp < m_tree.size(); stamp += stamp & (0 - stamp)) m_tree[stamp] += delta;
+        }
 
-    public:
-        explicit Impl(const PackageConfig& config) : m_config(config), m_cache(config.max_cache_size) {
-            if (m_config.encryption != EncryptionMethod::None && !m_config.encryption_key.empty()) {
-                m_cipher = std::make_unique<Cipher>(m_config.encryption_key);
-            }
+        uint64_t Prefix(size_t stamp) const {
+            uint64_t sum = 0;
+            for (; stamp > 0; stamp -= stamp & (0 - stamp)) sum += m_tree[stamp];
+            return sum;
         }
 
-        ~Impl() {
-            if (m_reader.is_open()) m_reader.close();
+        void EvictOldest() {
+            while (m_owner[m_oldest] == 0) ++m_oldest;
+            auto it = m_tracked.find(m_owner[m_oldest]);
+            Add(m_oldest, 0 - uint64_t(it->second.size));
+            m_owner[m_oldest] = 0;
+            m_tracked.erase(it);
         }
 
-        PackageResult Add(std::string_view name, const uint8_t* data, size_t size) {
-            if (name.empty() || !data || size == 0) {
-                return PackageResult::Failure(PackageError::InvalidParameter, "Invalid parameters");
+        // Packs live stamps into 1..n in access order and rebuilds the tree
+        void Compact() {
+            std::vector<std::pair<size_t, uint32_t>> live;
+            live.reserve(m_tracked.size());
+            for (size_t stamp = 1; stamp < m_owner.size(); ++stamp) {
+                if (m_owner[stamp] != 0) live.emplace_back(stamp, m_owner[stamp]);
+            }
+            std::fill(m_tree.begin(), m_tree.end(), 0);
+            std::fill(m_owner.begin(), m_owner.end(), 0);
+            m_total = 0;
+            m_clock = 1;
+            m_oldest = 1;
+            for (const auto& [_, key] : live) {
+                Tracked& tracked = m_tracked[key];
+                tracked.stamp = m_clock;
+                Add(m_clock, tracked.size);
+                m_owner[m_clock++] = key;
             }
-            auto entry = std::make_unique<Entry>();
-            entry->name = name;
-            entry->stored_name = m_config.obfuscate_filenames ? hash::Obfuscate(name) : std::string(name);
-            entry->data.assign(data, data + size);
-            entry->uncompressed_size = static_cast<uint32_t>(size);
-            entry->crc32 = pak_utils::CalculateCRC32(data, size);
-            entry->is_encrypted = (m_config.encryption != EncryptionMethod::None);
-            entry->is_loaded = true;
-            m_entries[std::string(name)] = std::move(entry);
-            return PackageResult::Success();
         }
 
-        PackageResult AddFromFile(std::string_view name, std::string_view filepath) {
-            std::ifstream file(std::string(filepath), std::ios::binary);
-            if (!file.is_open()) {
-                return PackageResult::Failure(PackageError::FileNotFound, "Cannot open file");
+        const uint32_t m_threshold;
+        const size_t m_max_tracked;
+        std::unordered_map<uint32_t, Tracked> m_tracked;
+        std::vector<uint64_t> m_tree;
+        std::vector<uint32_t> m_owner; // Key last accessed at each stamp, 0 once superseded
+        size_t m_clock{ 1 };
+        size_t m_oldest{ 1 };
+        uint64_t m_total{ 0 };
+        uint64_t m_accesses{ 0 };
+        uint64_t m_since_retune{ 0 };
+        std::array<uint64_t, BUCKETS> m_histogram{};
+        alignas(64) std::atomic<uint64_t> m_references{ 0 };
+        mutable std::mutex m_mutex;
+    };
+
+    // First-order successor model: for each entry, the few names most often requested right after it.
+    // Each node keeps a bounded successor list (space-saving replacement) and halves its counts as it
+    // ages, so the model follows changes in content and load order. Successors are learned per thread,
+    // so threads streaming different content do not record each other's requests as transitions.
+    class AccessPredictor {
+    public:
+        // Records name as the successor of the calling thread's previous access and returns the names likely to follow it
+        std::vector<std::string> Record(std::string_view name, size_t depth, double min_confidence) {
+            std::lock_guard lock(m_mutex);
+            // Threads that have gone away leave their entry behind; forgetting all of them costs one transition each
+            if (m_last.size() >= MAX_THREADS && !m_last.count(std::this_thread::get_id())) m_last.clear();
+            std::string& last = m_last[std::this_thread::get_id()];
+            if (!last.empty() && last != name) {
+                Node& node = m_nodes.try_emplace(last).first->second;
+                auto it = std::find_if(node.successors.begin(), node.successors.end(),
+                    [&](const Successor& successor) { return successor.name == name; });
+                if (it != node.successors.end()) {
+                    ++it->count;
+                }
+                else if (node.successors.size() < MAX_SUCCESSORS) {
+                    node.successors.push_back({ std::string(name), 1 });
+                }
+                else {
+                    auto weakest = std::min_element(node.successors.begin(), node.successors.end(),
+                        [](const Successor& a, const Successor& b) { return a.count < b.count; });
+                    *weakest = { std::string(name), weakest->count + 1 };
+                }
+                if (++node.total > DECAY_LIMIT) {
+                    node.total = 0;
+                    for (auto& successor : node.successors) node.total += successor.count /= 2;
+                }
             }
-            file.seekg(0, std::ios::end);
-            size_t size = file.tellg();
-            file.seekg(0, std::ios::beg);
-            ByteArray data(size);
-            if (!file.read(reinterpret_cast<char*>(data.data()), size)) {
-                return PackageResult::Failure(PackageError::IOError, "Cannot read file");
+            last = name;
+
+            std::vector<std::string> predictions;
+            auto it = m_nodes.find(name);
+            if (it == m_nodes.end() || it->second.total == 0) return predictions;
+            std::vector<const Successor*> ranked;
+            for (const auto& successor : it->second.successors) ranked.push_back(&successor);
+            std::sort(ranked.begin(), ranked.end(), [](const Successor* a, const Successor* b) { return a->count > b->count; });
+            for (const Successor* successor : ranked) {
+                if (predictions.size() == depth ||
+                    successor->count < min_confidence * it->second.total) {
+                    break;
+                }
+                predictions.push_back(successor->name);
             }
-            return Add(name, data.data(), data.size());
+            return predictions;
         }
 
-        PackageResult AddDirectory(std::string_view directory, bool recursive, ProgressCallback callback) {
-            std::string dir_str(directory);
-            if (!fs::exists(dir_str) || !fs::is_directory(dir_str)) {
-                return PackageResult::Failure(PackageError::FileNotFound, "Directory not found");
+        bool Save(std::ostream& stream) const;
+        bool Load(std::istream& stream);
+
+    private:
+        static constexpr size_t MAX_SUCCESSORS = 4;
+        static constexpr uint32_t DECAY_LIMIT = 1024;
+        static constexpr size_t MAX_THREADS = 256;
+
+        struct Successor {
+            std::string name;
+            uint32_t count{ 0 };
+        };
+
+        struct Node {
+            uint32_t total{ 0 };
+            std::vector<Successor> successors;
+        };
+
+        std::unordered_map<std::string, Node, StringHash, std::equal_to<>> m_nodes;
+        std::unordered_map<std::thread::id, std::string> m_last;
+        mutable std::mutex m_mutex;
+    };
+
+    enum class EntryFlags : uint8_t {
+        None = 0,
+        Encrypted = 1 << 0,
+        Chunked = 1 << 1,
+        Stored = 1 << 2, // Raw bytes, deflate did not pay off or was disabled
+        Inline = 1 << 3  // Bytes follow the directory record instead of living in the data area
+    };
+
+    // Recycles transient staging buffers in power-of-two size classes, retaining at most 'capacity' bytes
+    class BufferPool {
+    public:
+        static constexpr unsigned MIN_CLASS = 12; // 4 KB
+        static constexpr unsigned MAX_CLASS = 28; // 256 MB
+
+        class Lease {
+        public:
+            Lease() = default;
+            Lease(BufferPool* pool, Blob buffer) : m_pool(pool), m_buffer(std::move(buffer)) {}
+            Lease(Lease&& other) noexcept : m_pool(std::exchange(other.m_pool, nullptr)), m_buffer(std::move(other.m_buffer)) {}
+            Lease& operator=(Lease&& other) noexcept {
+                if (this != &other) {
+                    Return();
+                    m_pool = std::exchange(other.m_pool, nullptr);
+                    m_buffer = std::move(other.m_buffer);
+                }
+                return *this;
+            }
+            ~Lease() { Return(); }
+
+            Blob& operator*() { return m_buffer; }
+            Blob* operator->() { return &m_buffer; }
+
+        private:
+            void Return() {
+                if (m_pool) m_pool->Release(std::move(m_buffer));
+                m_pool = nullptr;
+            }
+
+            BufferPool* m_pool{ nullptr };
+            Blob m_buffer;
+        };
+
+        BufferPool(size_t capacity, std::pmr::memory_resource* resource) : m_capacity(capacity), m_resource(resource) {}
+
+        // Returns a buffer resized to 'size'; pooled buffers keep their previous contents
+        Lease Acquire(size_t size) {
+            unsigned cls = ClassFor(size);
+            Blob buffer(m_resource);
+            {
+                std::lock_guard lock(m_mutex);
+                ++m_stats.acquisitions;
+                if (cls <= MAX_CLASS && !m_free[cls - MIN_CLASS].empty()) {
+                    buffer = std::move(m_free[cls - MIN_CLASS].back());
+                    m_free[cls - MIN_CLASS].pop_back();
+                    m_stats.retained_bytes -= buffer.capacity();
+                    ++m_stats.reuses;
+                }
+                else {
+                    ++m_stats.allocations;
+                }
+            }
+            if (buffer.capacity() == 0 && cls <= MAX_CLASS) buffer.reserve(size_t(1) << cls);
+            buffer.resize(size);
+            return Lease(this, std::move(buffer));
+        }
+
+        // Memory an Acquire(size) lease occupies
+        static size_t Footprint(size_t size) {
+            unsigned cls = ClassFor(size);
+            return cls <= MAX_CLASS ? std::max(size, size_t(1) << cls) : size;
+        }
+
+        void Clear() {
+            std::lock_guard lock(m_mutex);
+            for (auto& list : m_free) list.clear();
+            m_stats.retained_bytes = 0;
+        }
+
+        BufferPoolStats Stats() const {
+            std::lock_guard lock(m_mutex);
+            BufferPoolStats stats = m_stats;
+            stats.retained_limit = m_capacity;
+            return stats;
+        }
+
+    private:
+        static unsigned ClassFor(size_t size) {
+            return std::max<unsigned>(MIN_CLASS, static_cast<unsigned>(std::bit_width(size > 0 ? size - 1 : 0)));
+        }
+
+        void Release(Blob buffer) {
+            size_t capacity = buffer.capacity();
+            // A buffer of capacity >= 2^k can serve every request of class k
+            unsigned cls = capacity > 0 ? static_cast<unsigned>(std::bit_width(capacity)) - 1 : 0;
+            std::lock_guard lock(m_mutex);
+            if (cls < MIN_CLASS || cls > MAX_CLASS || m_stats.retained_bytes + capacity > m_capacity) {
+                ++m_stats.discards;
+                return;
+            }
+            m_free[cls - MIN_CLASS].push_back(std::move(buffer));
+            m_stats.retained_bytes += capacity;
+            m_stats.peak_retained_bytes = std::max(m_stats.peak_retained_bytes, m_stats.retained_bytes);
+        }
+
+        size_t m_capacity;
+        std::pmr::memory_resource* m_resource;
+        std::vector<Blob> m_free[MAX_CLASS - MIN_CLASS + 1];
+        BufferPoolStats m_stats;
+        mutable std::mutex m_mutex;
+    };
+
+    // Byte budget shared by the stages of bulk pipelines: work takes credit for the memory it will hold
+    // and gives it back when done, so a fast stage waits instead of queueing unbounded output. An amount
+    // larger than the whole budget is granted once nothing else holds credit, so an oversized entry
+    // runs alone instead of never. A limit of 0 grants everything.
+    class ByteCredit {
+    public:
+        class Grant {
+        public:
+            Grant() = default;
+            Grant(ByteCredit* credit, size_t bytes) : m_credit(credit), m_bytes(bytes) {}
+            Grant(Grant&& other) noexcept : m_credit(std::exchange(other.m_credit, nullptr)), m_bytes(other.m_bytes) {}
+            Grant& operator=(Grant&& other) noexcept {
+                if (this != &other) {
+                    Return();
+                    m_credit = std::exchange(other.m_credit, nullptr);
+                    m_bytes = other.m_bytes;
+                }
+                return *this;
+            }
+            ~Grant() { Return(); }
+
+            explicit operator bool() const { return m_credit != nullptr; }
+
+        private:
+            void Return() {
+                if (m_credit) m_credit->Release(m_bytes);
+                m_credit = nullptr;
+            }
+
+            ByteCredit* m_credit{ nullptr };
+            size_t m_bytes{ 0 };
+        };
+
+        explicit ByteCredit(size_t limit) : m_limit(limit) {}
+
+        // Blocks until the bytes fit; callers must not already hold credit the wait depends on
+        Grant Acquire(size_t bytes) {
+            std::unique_lock lock(m_mutex);
+            m_released.wait(lock, [&] { return Fits(bytes); });
+            m_used += bytes;
+            return Grant(this, bytes);
+        }
+
+        // An empty grant when the bytes do not fit now
+        Grant TryAcquire(size_t bytes) {
+            std::lock_guard lock(m_mutex);
+            if (!Fits(bytes)) return {};
+            m_used += bytes;
+            return Grant(this, bytes);
+        }
+
+    private:
+        bool Fits(size_t bytes) const { return m_limit == 0 || m_used == 0 || m_used + bytes <= m_limit; }
+
+        void Release(size_t bytes) {
+            {
+                std::lock_guard lock(m_mutex);
+                m_used -= bytes;
+            }
+            m_released.notify_all();
+        }
+
+        const size_t m_limit;
+        size_t m_used{ 0 };
+        std::mutex m_mutex;
+        std::condition_variable m_released;
+    };
+
+    // Fixed-size memory region carved into slabs; each slab serves one power-of-two size class and
+    // allocations larger than a slab take a run of whole slabs. Freeing never returns memory to the OS.
+    class SlabArena : public std::pmr::memory_resource {
+    public:
+        static constexpr size_t MIN_BLOCK = 64;
+
+        SlabArena(size_t capacity, bool huge_pages) {
+            m_slab_size = std::clamp<size_t>(std::bit_floor(std::max<size_t>(capacity / 64, 1)), 64 * 1024, 1024 * 1024);
+            size_t slab_count = std::max<size_t>(capacity / m_slab_size, 1);
+            m_size = slab_count * m_slab_size;
+            m_base = static_cast<uint8_t*>(MapRegion(m_size, huge_pages));
+            m_slabs.resize(slab_count);
+            size_t classes = std::bit_width(m_slab_size / MIN_BLOCK);
+            m_partial.assign(classes, NO_SLAB);
+        }
+
+        ~SlabArena() override {
+            UnmapRegion(m_base, m_size);
+        }
+
+        SlabArena(const SlabArena&) = delete;
+        SlabArena& operator=(const SlabArena&) = delete;
+
+        size_t Capacity() const noexcept { return m_size; }
+        bool UsesHugePages() const noexcept { return m_huge_pages; }
+
+    protected:
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            size_t size = std::max({ bytes, alignment, MIN_BLOCK });
+            std::lock_guard lock(m_mutex);
+            void* block = size > m_slab_size ? AllocateRun((size + m_slab_size - 1) / m_slab_size)
+                : AllocateBlock(static_cast<unsigned>(std::bit_width(std::bit_ceil(size) / MIN_BLOCK) - 1));
+            if (!block) throw std::bad_alloc();
+            return block;
+        }
+
+        void do_deallocate(void* ptr, size_t, size_t) override {
+            std::lock_guard lock(m_mutex);
+            size_t index = static_cast<size_t>(static_cast<uint8_t*>(ptr) - m_base) / m_slab_size;
+            Slab& slab = m_slabs[index];
+            if (slab.size_class == RUN) {
+                for (size_t i = 0; i < slab.run_length; ++i) m_slabs[index + i].size_class = FREE;
+                return;
+            }
+            *static_cast<void**>(ptr) = slab.free_list;
+            slab.free_list = ptr;
+            if (slab.used-- == BlocksPerSlab(slab.size_class)) LinkPartial(index);
+            if (slab.used == 0) {
+                UnlinkPartial(index);
+                slab.size_class = FREE;
+            }
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+
+    private:
+        static constexpr int FREE = -1;
+        static constexpr int RUN = -2;
+        static constexpr int RUN_TAIL = -3;
+        static constexpr size_t NO_SLAB = SIZE_MAX;
+
+        struct Slab {
+            int size_class{ FREE };
+            size_t used{ 0 };
+            size_t bump{ 0 };
+            size_t run_length{ 0 };
+            void* free_list{ nullptr };
+            size_t prev{ NO_SLAB };
+            size_t next{ NO_SLAB };
+        };
+
+        size_t BlockSize(int cls) const { return MIN_BLOCK << cls; }
+        size_t BlocksPerSlab(int cls) const { return m_slab_size / BlockSize(cls); }
+
+        void* AllocateBlock(unsigned cls) {
+            size_t index = m_partial[cls];
+            if (index == NO_SLAB) {
+                index = FindFreeSlabs(1);
+                if (index == NO_SLAB) return nullptr;
+                m_slabs[index] = Slab{};
+                m_slabs[index].size_class = static_cast<int>(cls);
+                LinkPartial(index);
+            }
+            Slab& slab = m_slabs[index];
+            void* block;
+            if (slab.free_list) {
+                block = slab.free_list;
+                slab.free_list = *static_cast<void**>(block);
+            }
+            else {
+                block = m_base + index * m_slab_size + slab.bump * BlockSize(cls);
+                ++slab.bump;
+            }
+            if (++slab.used == BlocksPerSlab(cls)) UnlinkPartial(index);
+            return block;
+        }
+
+        void* AllocateRun(size_t count) {
+            size_t index = FindFreeSlabs(count);
+            if (index == NO_SLAB) return nullptr;
+            for (size_t i = 0; i < count; ++i) m_slabs[index + i].size_class = RUN_TAIL;
+            m_slabs[index].size_class = RUN;
+            m_slabs[index].run_length = count;
+            return m_base + index * m_slab_size;
+        }
+
+        size_t FindFreeSlabs(size_t count) const {
+            size_t run = 0;
+            for (size_t i = 0; i < m_slabs.size(); ++i) {
+                run = m_slabs[i].size_class == FREE ? run + 1 : 0;
+                if (run == count) return i + 1 - count;
+            }
+            return NO_SLAB;
+        }
+
+        void LinkPartial(size_t index) {
+            Slab& slab = m_slabs[index];
+            size_t& head = m_partial[slab.size_class];
+            slab.prev = NO_SLAB;
+            slab.next = head;
+            if (head != NO_SLAB) m_slabs[head].prev = index;
+            head = index;
+        }
+
+        void UnlinkPartial(size_t index) {
+            Slab& slab = m_slabs[index];
+            if (slab.prev != NO_SLAB) m_slabs[slab.prev].next = slab.next;
+            else if (m_partial[slab.size_class] == index) m_partial[slab.size_class] = slab.next;
+            else return;
+            if (slab.next != NO_SLAB) m_slabs[slab.next].prev = slab.prev;
+            slab.prev = slab.next = NO_SLAB;
+        }
+
+        // Commits the whole region up front so resident memory stays at the configured size
+        void* MapRegion(size_t size, bool huge_pages) {
+#if defined(_WIN32)
+            if (huge_pages) {
+                SIZE_T large = GetLargePageMinimum();
+                if (large != 0 && size % large == 0) {
+                    if (void* region = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE)) {
+                        m_huge_pages = true;
+                        return region;
+                    }
+                }
+            }
+            if (void* region = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE)) return region;
+            throw std::bad_alloc();
+#elif defined(__unix__) || defined(__APPLE__)
+            int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#if defined(MAP_POPULATE)
+            flags |= MAP_POPULATE;
+#endif
+#if defined(MAP_HUGETLB)
+            if (huge_pages) {
+                void* region = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+                if (region != MAP_FAILED) {
+                    m_huge_pages = true;
+                    return region;
+                }
+            }
+#endif
+            void* region = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+            if (region == MAP_FAILED) throw std::bad_alloc();
+#if defined(MADV_HUGEPAGE)
+            if (huge_pages) m_huge_pages = madvise(region, size, MADV_HUGEPAGE) == 0;
+#endif
+            return region;
+#else
+            (void)huge_pages;
+            return ::operator new(size, std::align_val_t{ 4096 });
+#endif
+        }
+
+        static void UnmapRegion(void* region, size_t size) {
+#if defined(_WIN32)
+            (void)size;
+            VirtualFree(region, 0, MEM_RELEASE);
+#elif defined(__unix__) || defined(__APPLE__)
+            munmap(region, size);
+#else
+            (void)size;
+            ::operator delete(region, std::align_val_t{ 4096 });
+#endif
+        }
+
+        uint8_t* m_base{ nullptr };
+        size_t m_size{ 0 };
+        size_t m_slab_size{ 0 };
+        bool m_huge_pages{ false };
+        std::vector<Slab> m_slabs;
+        std::vector<size_t> m_partial;
+        std::mutex m_mutex;
+    };
+
+    struct PackageFile;
+
+    struct Entry {
+        explicit Entry(std::pmr::memory_resource* resource)
+            : name(resource), stored_name(resource), inline_data(resource) {}
+
+        std::pmr::string name;
+        std::pmr::string stored_name;
+        uint32_t offset{ 0 };
+        uint32_t compressed_size{ 0 };
+        uint32_t uncompressed_size{ 0 };
+        uint32_t crc32{ 0 };
+        bool is_encrypted{ false };
+        bool is_chunked{ false };
+        bool is_stored{ false };
+        bool is_inline{ false };
+        std::atomic<bool> is_loaded{ false }; // Set with release once data is complete, read through IsLoaded
+        BlobPtr data; // Never changed once loaded, so directory versions can share it
+        Blob inline_data; // Stored bytes of inline entries, read with the directory
+        std::shared_ptr<PackageFile> file; // Where offset points, null for entries added in memory
+
+        std::atomic<uint32_t> saved_size{ 0 }; // What the last Save wrote for an entry added in memory
+
+        uint32_t StoredSize() const noexcept { return file ? compressed_size : saved_size.load(std::memory_order_relaxed); }
+        bool IsLoaded() const noexcept { return is_loaded.load(std::memory_order_acquire); }
+
+        enum class DiskCacheState : uint8_t { Unknown, Present, Absent };
+        std::atomic<uint32_t> disk_cache_hits{ 0 };
+        std::atomic<DiskCacheState> disk_cache_state{ DiskCacheState::Unknown };
+    };
+
+    class Cipher {
+    public:
+        explicit Cipher(std::string_view key) {
+            if (key.empty()) {
+                m_key = { 0x52, 0x42, 0x50, 0x6B };
+            }
+            else {
+                DeriveKey(key);
+            }
+        }
+
+        // offset is the position of data within the entry, so blocks can be processed independently
+        void Encrypt(uint8_t* data, size_t size, size_t offset = 0) const {
+            if (m_key.empty() || !data) return;
+            for (size_t i = 0; i < size; ++i) {
+                data[i] ^= m_key[(offset + i) % m_key.size()];
+            }
+        }
+
+        void Decrypt(uint8_t* data, size_t size, size_t offset = 0) const {
+            Encrypt(data, size, offset);
+        }
+
+    private:
+        void DeriveKey(std::string_view input) {
+            m_key.clear();
+            m_key.reserve(32);
+            std::string seed = std::string(input) + "RBPak_Salt_2025";
+            for (size_t i = 0; i < 32; ++i) {
+                uint32_t hash = 2166136261u;
+                for (char c : seed) {
+                    hash ^= static_cast<uint32_t>(static_cast<uint8_t>(c));
+                    hash *= 16777619u;
+                }
+                m_key.push_back(static_cast<uint8_t>(hash & 0xFF));
+                seed += std::to_string(hash);
+            }
+        }
+        ByteArray m_key;
+    };
+
+    // Whole-buffer inflate for zlib streams whose uncompressed size is known up front.
+    // Returns false on anything unexpected so the caller can fall back to zlib.
+    namespace inflate {
+        constexpr unsigned LITLEN_ROOT = 11;
+        constexpr unsigned DIST_ROOT = 8;
+        constexpr size_t COPY_SLACK = 16;
+
+        enum : uint32_t { TypeLiteral = 0, TypeLength = 1, TypeEnd = 2, TypeSubtable = 3, TypeInvalid = 4 };
+
+        // value:16 | extra:5 | type:3 | bits:8
+        constexpr uint32_t MakeEntry(uint32_t value, uint32_t extra, uint32_t type, uint32_t bits) {
+            return (value << 16) | (extra << 11) | (type << 8) | bits;
+        }
+        constexpr uint32_t EntryValue(uint32_t e) { return e >> 16; }
+        constexpr uint32_t EntryExtra(uint32_t e) { return (e >> 11) & 0x1F; }
+        constexpr uint32_t EntryType(uint32_t e) { return (e >> 8) & 0x7; }
+        constexpr uint32_t EntryBits(uint32_t e) { return e & 0xFF; }
+
+        constexpr uint16_t LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+            35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+        constexpr uint8_t LENGTH_EXTRA[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+            3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+        constexpr uint16_t DIST_BASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+            257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+        constexpr uint8_t DIST_EXTRA[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+            7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+        constexpr uint8_t CODELEN_ORDER[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+        enum class Alphabet { LitLen, Dist, CodeLen };
+
+        // Primary tables are 2^root entries; each code longer than root adds at most one subtable
+        struct LitLenTable { uint32_t entries[(1u << LITLEN_ROOT) + 288 * (1u << (15 - LITLEN_ROOT))]; };
+        struct DistTable { uint32_t entries[(1u << DIST_ROOT) + 32 * (1u << (15 - DIST_ROOT))]; };
+
+        uint32_t SymbolEntry(Alphabet alphabet, uint32_t symbol, uint32_t bits) {
+            switch (alphabet) {
+            case Alphabet::CodeLen:
+                return MakeEntry(symbol, 0, TypeLiteral, bits);
+            case Alphabet::LitLen:
+                if (symbol < 256) return MakeEntry(symbol, 0, TypeLiteral, bits);
+                if (symbol == 256) return MakeEntry(0, 0, TypeEnd, bits);
+                if (symbol <= 285) return MakeEntry(LENGTH_BASE[symbol - 257], LENGTH_EXTRA[symbol - 257], TypeLength, bits);
+                return MakeEntry(0, 0, TypeInvalid, bits);
+            case Alphabet::Dist:
+                if (symbol < 30) return MakeEntry(DIST_BASE[symbol], DIST_EXTRA[symbol], TypeLength, bits);
+                return MakeEntry(0, 0, TypeInvalid, bits);
+            }
+            return MakeEntry(0, 0, TypeInvalid, bits);
+        }
+
+        uint32_t ReverseBits(uint32_t code, unsigned length) {
+            uint32_t result = 0;
+            for (unsigned i = 0; i < length; ++i) {
+                result = (result << 1) | (code & 1);
+                code >>= 1;
+            }
+            return result;
+        }
+
+        // Builds an LSB-first canonical Huffman lookup table with one level of subtables
+        bool BuildTable(const uint8_t* lengths, unsigned count, Alphabet alphabet, unsigned root,
+            uint32_t* table, size_t capacity) {
+            uint16_t bl_count[16] = {};
+            for (unsigned i = 0; i < count; ++i) bl_count[lengths[i]]++;
+            bl_count[0] = 0;
+            int left = 1;
+            for (unsigned len = 1; len <= 15; ++len) {
+                left = (left << 1) - bl_count[len];
+                if (left < 0) return false;
+            }
+            uint32_t next_code[16] = {};
+            uint32_t code = 0;
+            for (unsigned len = 1; len <= 15; ++len) {
+                code = (code + bl_count[len - 1]) << 1;
+                next_code[len] = code;
+            }
+
+            const size_t root_size = size_t(1) << root;
+            const uint32_t root_mask = static_cast<uint32_t>(root_size - 1);
+            std::fill(table, table + root_size, MakeEntry(0, 0, TypeInvalid, 0));
+
+            uint32_t codes[288];
+            uint8_t sub_length[1u << LITLEN_ROOT] = {};
+            for (unsigned sym = 0; sym < count; ++sym) {
+                unsigned len = lengths[sym];
+                if (len == 0) continue;
+                codes[sym] = ReverseBits(next_code[len]++, len);
+                if (len > root) {
+                    uint8_t& max_len = sub_length[codes[sym] & root_mask];
+                    max_len = std::max<uint8_t>(max_len, static_cast<uint8_t>(len));
+                }
+            }
+
+            size_t next = root_size;
+            for (size_t prefix = 0; prefix < root_size; ++prefix) {
+                if (sub_length[prefix] == 0) continue;
+                unsigned sub_bits = sub_length[prefix] - root;
+                size_t sub_size = size_t(1) << sub_bits;
+                if (next + sub_size > capacity) return false;
+                table[prefix] = MakeEntry(static_cast<uint32_t>(next), sub_bits, TypeSubtable, root);
+                std::fill(table + next, table + next + sub_size, MakeEntry(0, 0, TypeInvalid, 0));
+                next += sub_size;
+            }
+
+            for (unsigned sym = 0; sym < count; ++sym) {
+                unsigned len = lengths[sym];
+                if (len == 0) continue;
+                uint32_t rev = codes[sym];
+                if (len <= root) {
+                    uint32_t entry = SymbolEntry(alphabet, sym, len);
+                    for (size_t i = rev; i < root_size; i += size_t(1) << len) table[i] = entry;
+                }
+                else {
+                    uint32_t pointer = table[rev & root_mask];
+                    uint32_t* sub = table + EntryValue(pointer);
+                    unsigned sub_len = len - root;
+                    uint32_t entry = SymbolEntry(alphabet, sym, sub_len);
+                    for (size_t i = rev >> root; i < (size_t(1) << EntryExtra(pointer)); i += size_t(1) << sub_len) sub[i] = entry;
+                }
+            }
+            return true;
+        }
+
+        class BitReader {
+        public:
+            BitReader(const uint8_t* data, size_t size) : m_in(data), m_end(data + size) {}
+
+            // Branchless word refill while 8 bytes remain, bytewise near the end
+            void Refill() {
+                if (m_end - m_in >= 8) {
+                    uint64_t word;
+                    std::memcpy(&word, m_in, sizeof(word));
+                    m_buf |= word << m_count;
+                    m_in += (63 - m_count) >> 3;
+                    m_count |= 56;
+                }
+                else {
+                    while (m_count <= 56 && m_in < m_end) {
+                        m_buf |= static_cast<uint64_t>(*m_in++) << m_count;
+                        m_count += 8;
+                    }
+                }
+            }
+
+            uint32_t Peek(unsigned n) const { return static_cast<uint32_t>(m_buf & ((uint64_t(1) << n) - 1)); }
+
+            bool Consume(unsigned n) {
+                if (n > m_count) return false;
+                m_buf >>= n;
+                m_count -= n;
+                return true;
+            }
+
+            bool Read(unsigned n, uint32_t& value) {
+                if (m_count < n) Refill();
+                value = Peek(n);
+                return Consume(n);
+            }
+
+            void AlignToByte() { Consume(m_count & 7); }
+
+            // Drops buffered whole bytes back to the input so stored blocks can be copied directly
+            void Rewind() {
+                m_in -= m_count >> 3;
+                m_buf = 0;
+                m_count = 0;
+            }
+
+            const uint8_t* Position() const { return m_in; }
+            size_t Remaining() const { return static_cast<size_t>(m_end - m_in); }
+            void Skip(size_t n) { m_in += n; }
+
+        private:
+            const uint8_t* m_in;
+            const uint8_t* m_end;
+            uint64_t m_buf{ 0 };
+            unsigned m_count{ 0 };
+        };
+
+        inline bool DecodeSymbol(BitReader& bits, const uint32_t* table, unsigned root, uint32_t& entry) {
+            entry = table[bits.Peek(root)];
+            if (EntryType(entry) == TypeSubtable) {
+                if (!bits.Consume(root)) return false;
+                entry = table[EntryValue(entry) + bits.Peek(EntryExtra(entry))];
+            }
+            return bits.Consume(EntryBits(entry)) && EntryType(entry) != TypeInvalid;
+        }
+
+        inline void Copy16(uint8_t* dst, const uint8_t* src) {
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+            vst1q_u8(dst, vld1q_u8(src));
+#else
+            std::memcpy(dst, src, 16);
+#endif
+        }
+
+        // Copies a match; with slack available it may write up to COPY_SLACK bytes past the end
+        inline void CopyMatch(uint8_t* out, size_t dist, size_t length, bool has_slack) {
+            const uint8_t* src = out - dist;
+            if (has_slack && dist >= 16) {
+                uint8_t* end = out + length;
+                do {
+                    Copy16(out, src);
+                    out += 16;
+                    src += 16;
+                } while (out < end);
+            }
+            else if (has_slack && dist >= 8) {
+                uint8_t* end = out + length;
+                do {
+                    uint64_t word;
+                    std::memcpy(&word, src, sizeof(word));
+                    std::memcpy(out, &word, sizeof(word));
+                    out += 8;
+                    src += 8;
+                } while (out < end);
+            }
+            else if (dist == 1) {
+                std::memset(out, *src, length);
+            }
+            else {
+                for (size_t i = 0; i < length; ++i) out[i] = src[i];
+            }
+        }
+
+        bool ReadDynamicTables(BitReader& bits, LitLenTable& litlen, DistTable& dist) {
+            uint32_t hlit, hdist, hclen;
+            if (!bits.Read(5, hlit) || !bits.Read(5, hdist) || !bits.Read(4, hclen)) return false;
+            hlit += 257;
+            hdist += 1;
+            hclen += 4;
+            if (hlit > 286 || hdist > 30) return false;
+
+            uint8_t codelen_lengths[19] = {};
+            for (uint32_t i = 0; i < hclen; ++i) {
+                uint32_t len;
+                if (!bits.Read(3, len)) return false;
+                codelen_lengths[CODELEN_ORDER[i]] = static_cast<uint8_t>(len);
+            }
+            uint32_t codelen_table[1u << 7];
+            if (!BuildTable(codelen_lengths, 19, Alphabet::CodeLen, 7, codelen_table, std::size(codelen_table))) return false;
+
+            uint8_t lengths[286 + 30] = {};
+            uint32_t total = hlit + hdist;
+            for (uint32_t i = 0; i < total;) {
+                bits.Refill();
+                uint32_t entry;
+                if (!DecodeSymbol(bits, codelen_table, 7, entry)) return false;
+                uint32_t symbol = EntryValue(entry);
+                if (symbol < 16) {
+                    lengths[i++] = static_cast<uint8_t>(symbol);
+                    continue;
+                }
+                uint32_t repeat;
+                uint8_t value = 0;
+                if (symbol == 16) {
+                    if (i == 0 || !bits.Read(2, repeat)) return false;
+                    value = lengths[i - 1];
+                    repeat += 3;
+                }
+                else if (symbol == 17) {
+                    if (!bits.Read(3, repeat)) return false;
+                    repeat += 3;
+                }
+                else {
+                    if (!bits.Read(7, repeat)) return false;
+                    repeat += 11;
+                }
+                if (i + repeat > total) return false;
+                std::memset(lengths + i, value, repeat);
+                i += repeat;
+            }
+            if (lengths[256] == 0) return false;
+            return BuildTable(lengths, hlit, Alphabet::LitLen, LITLEN_ROOT, litlen.entries, std::size(litlen.entries)) &&
+                BuildTable(lengths + hlit, hdist, Alphabet::Dist, DIST_ROOT, dist.entries, std::size(dist.entries));
+        }
+
+        struct FixedTables {
+            LitLenTable litlen;
+            DistTable dist;
+            bool valid{ false };
+
+            FixedTables() {
+                uint8_t lengths[288 + 32];
+                std::fill(lengths, lengths + 144, 8);
+                std::fill(lengths + 144, lengths + 256, 9);
+                std::fill(lengths + 256, lengths + 280, 7);
+                std::fill(lengths + 280, lengths + 288, 8);
+                std::fill(lengths + 288, lengths + 320, 5);
+                valid = BuildTable(lengths, 288, Alphabet::LitLen, LITLEN_ROOT, litlen.entries, std::size(litlen.entries)) &&
+                    BuildTable(lengths + 288, 32, Alphabet::Dist, DIST_ROOT, dist.entries, std::size(dist.entries));
+            }
+        };
+
+        bool DecodeHuffmanBlock(BitReader& bits, const uint32_t* litlen, const uint32_t* dist,
+            uint8_t* out_begin, uint8_t*& out, uint8_t* out_end) {
+            for (;;) {
+                bits.Refill();
+                uint32_t entry;
+                if (!DecodeSymbol(bits, litlen, LITLEN_ROOT, entry)) return false;
+                uint32_t type = EntryType(entry);
+                if (type == TypeLiteral) {
+                    if (out == out_end) return false;
+                    *out++ = static_cast<uint8_t>(EntryValue(entry));
+                    // A refill guarantees 56 bits, enough for a second literal code without reloading
+                    if (!DecodeSymbol(bits, litlen, LITLEN_ROOT, entry)) return false;
+                    type = EntryType(entry);
+                    if (type == TypeLiteral) {
+                        if (out == out_end) return false;
+                        *out++ = static_cast<uint8_t>(EntryValue(entry));
+                        continue;
+                    }
+                }
+                if (type == TypeEnd) return true;
+
+                uint32_t extra = 0;
+                if (EntryExtra(entry) && !bits.Read(EntryExtra(entry), extra)) return false;
+                size_t length = EntryValue(entry) + extra;
+
+                bits.Refill();
+                if (!DecodeSymbol(bits, dist, DIST_ROOT, entry)) return false;
+                extra = 0;
+                if (EntryExtra(entry) && !bits.Read(EntryExtra(entry), extra)) return false;
+                size_t distance = EntryValue(entry) + extra;
+
+                if (distance > static_cast<size_t>(out - out_begin)) return false;
+                size_t room = static_cast<size_t>(out_end - out);
+                if (length > room) return false;
+                CopyMatch(out, distance, length, room >= length + COPY_SLACK);
+                out += length;
+            }
+        }
+
+        bool Decode(const uint8_t* input, size_t input_size, uint8_t* output, size_t output_size) {
+            if constexpr (std::endian::native != std::endian::little) {
+                return false;
+            }
+            if (input_size < 6) return false;
+            uint32_t cmf = input[0], flg = input[1];
+            if ((cmf & 0x0F) != 8 || (cmf >> 4) > 7 || ((cmf << 8) | flg) % 31 != 0 || (flg & 0x20)) return false;
+
+            static const FixedTables fixed;
+            if (!fixed.valid) return false;
+            thread_local std::unique_ptr<LitLenTable> dynamic_litlen = std::make_unique<LitLenTable>();
+            thread_local std::unique_ptr<DistTable> dynamic_dist = std::make_unique<DistTable>();
+
+            BitReader bits(input + 2, input_size - 2);
+            uint8_t* out = output;
+            uint8_t* out_end = output + output_size;
+            uint32_t final_block = 0;
+            while (!final_block) {
+                uint32_t type;
+                if (!bits.Read(1, final_block) || !bits.Read(2, type)) return false;
+                if (type == 0) {
+                    bits.AlignToByte();
+                    bits.Rewind();
+                    if (bits.Remaining() < 4) return false;
+                    const uint8_t* header = bits.Position();
+                    uint32_t len = header[0] | (header[1] << 8);
+                    uint32_t nlen = header[2] | (header[3] << 8);
+                    if ((len ^ 0xFFFF) != nlen) return false;
+                    bits.Skip(4);
+                    if (bits.Remaining() < len || static_cast<size_t>(out_end - out) < len) return false;
+                    std::memcpy(out, bits.Position(), len);
+                    bits.Skip(len);
+                    out += len;
+                }
+                else if (type == 1) {
+                    if (!DecodeHuffmanBlock(bits, fixed.litlen.entries, fixed.dist.entries, output, out, out_end)) return false;
+                }
+                else if (type == 2) {
+                    if (!ReadDynamicTables(bits, *dynamic_litlen, *dynamic_dist)) return false;
+                    if (!DecodeHuffmanBlock(bits, dynamic_litlen->entries, dynamic_dist->entries, output, out, out_end)) return false;
+                }
+                else {
+                    return false;
+                }
+            }
+            if (out != out_end) return false;
+
+            bits.AlignToByte();
+            uint32_t expected_adler = 0;
+            for (int i = 0; i < 4; ++i) {
+                uint32_t byte;
+                if (!bits.Read(8, byte)) return false;
+                expected_adler = (expected_adler << 8) | byte;
+            }
+            uLong adler = adler32(1L, nullptr, 0);
+            for (size_t done = 0; done < output_size;) {
+                uInt step = static_cast<uInt>(std::min<size_t>(output_size - done, UINT32_MAX));
+                adler = adler32(adler, output + done, step);
+                done += step;
+            }
+            return static_cast<uint32_t>(adler) == expected_adler;
+        }
+    }
+
+    namespace compression {
+        constexpr size_t MAX_DECOMPRESSED_SIZE = 1024ULL * 1024 * 1024; // Largest output of one Decompress call
+        constexpr uint64_t MAX_INFLATE_RATIO = 1032; // The most deflate can expand its input
+
+        // zlib streams are expensive to set up, so each thread keeps one of each and resets it per entry
+        class DeflateContext {
+        public:
+            ~DeflateContext() {
+                if (m_ready) deflateEnd(&m_stream);
+            }
+
+            z_stream* Acquire(int level) {
+                if (m_ready && m_level == level) {
+                    if (deflateReset(&m_stream) == Z_OK) return &m_stream;
+                }
+                if (m_ready) deflateEnd(&m_stream);
+                m_stream = z_stream{};
+                m_ready = deflateInit(&m_stream, level) == Z_OK;
+                m_level = level;
+                return m_ready ? &m_stream : nullptr;
+            }
+
+        private:
+            z_stream m_stream{};
+            int m_level{ 0 };
+            bool m_ready{ false };
+        };
+
+        class InflateContext {
+        public:
+            ~InflateContext() {
+                if (m_ready) inflateEnd(&m_stream);
+            }
+
+            z_stream* Acquire() {
+                if (m_ready) {
+                    if (inflateReset(&m_stream) == Z_OK) return &m_stream;
+                    inflateEnd(&m_stream);
+                }
+                m_stream = z_stream{};
+                m_ready = inflateInit(&m_stream) == Z_OK;
+                return m_ready ? &m_stream : nullptr;
+            }
+
+        private:
+            z_stream m_stream{};
+            bool m_ready{ false };
+        };
+
+        PackageResult Compress(const uint8_t* input, size_t input_size, Blob& output, CompressionLevel level) {
+            if (!input || input_size == 0) {
+                return PackageResult::Failure(PackageError::InvalidParameter, "Empty input");
+            }
+            if (level == CompressionLevel::None) {
+                output.assign(input, input + input_size);
+                return PackageResult::Success();
+            }
+            thread_local DeflateContext context;
+            z_stream* stream = context.Acquire(static_cast<int>(level));
+            if (!stream) {
+                return PackageResult::Failure(PackageError::OutOfMemory, "Cannot initialise deflate");
+            }
+            uLong bound = deflateBound(stream, static_cast<uLong>(input_size));
+            output.resize(bound);
+            stream->next_in = const_cast<Bytef*>(input);
+            stream->avail_in = static_cast<uInt>(input_size);
+            stream->next_out = output.data();
+            stream->avail_out = static_cast<uInt>(bound);
+            int result = deflate(stream, Z_FINISH);
+            if (result != Z_STREAM_END) {
+                return PackageResult::Failure(PackageError::CompressionFailed, "zlib error: " + std::to_string(result));
+            }
+            output.resize(stream->total_out);
+            return PackageResult::Success();
+        }
+
+        // Inflates into a caller-owned buffer that must be exactly the uncompressed size
+        PackageResult Decompress(const uint8_t* input, size_t input_size, uint8_t* output, size_t expected) {
+            if (!input || input_size == 0 || !output) {
+                return PackageResult::Failure(PackageError::InvalidParameter, "Empty compressed data");
+            }
+            if (expected == 0 || expected > MAX_DECOMPRESSED_SIZE) {
+                return PackageResult::Failure(PackageError::InvalidParameter, "Invalid size");
+            }
+            if (inflate::Decode(input, input_size, output, expected)) {
+                return PackageResult::Success();
+            }
+            thread_local InflateContext context;
+            z_stream* stream = context.Acquire();
+            if (!stream) {
+                return PackageResult::Failure(PackageError::OutOfMemory, "Cannot initialise inflate");
+            }
+            stream->next_in = const_cast<Bytef*>(input);
+            stream->avail_in = static_cast<uInt>(input_size);
+            stream->next_out = output;
+            stream->avail_out = static_cast<uInt>(expected);
+            int result = ::inflate(stream, Z_FINISH);
+            if (result != Z_STREAM_END) {
+                return PackageResult::Failure(PackageError::DecompressionFailed, "zlib error: " + std::to_string(result));
+            }
+            if (stream->total_out != expected) {
+                return PackageResult::Failure(PackageError::CorruptedData, "Size mismatch");
+            }
+            return PackageResult::Success();
+        }
+    }
+
+    // The package's own JobSystem. Each worker owns a deque: jobs it submits go to the back and it takes
+    // from the back, so nested work runs while its data is still in cache; idle workers steal the oldest
+    // job from the front of another worker's deque. Jobs from other threads are dealt round robin.
+    class WorkStealingScheduler final : public JobSystem {
+    public:
+        WorkStealingScheduler(unsigned workers, const std::vector<uint32_t>& cpus) : m_queues(std::max(workers, 1u)) {
+            m_threads.reserve(m_queues.size());
+            for (size_t i = 0; i < m_queues.size(); ++i) {
+                m_threads.emplace_back([this, i] { Run(i); });
+                if (!cpus.empty()) Pin(m_threads.back(), cpus[i % cpus.size()]);
+            }
+        }
+
+        // Jobs already submitted still run
+        ~WorkStealingScheduler() override {
+            {
+                std::lock_guard lock(m_sleep_mutex);
+                m_stop = true;
+            }
+            m_wake.notify_all();
+            for (auto& thread : m_threads) thread.join();
+        }
+
+        void Submit(std::function<void()> job) override {
+            size_t index = t_owner == this ? t_index : m_next.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+            {
+                std::lock_guard lock(m_queues[index].mutex);
+                m_queues[index].jobs.push_back(std::move(job));
+            }
+            m_pending.fetch_add(1, std::memory_order_release);
+            // Taking the lock orders this with a worker that checked m_pending and is about to sleep
+            { std::lock_guard lock(m_sleep_mutex); }
+            m_wake.notify_one();
+        }
+
+        unsigned Concurrency() const override { return static_cast<unsigned>(m_threads.size()); }
+
+    private:
+        struct alignas(64) Queue {
+            std::mutex mutex;
+            std::deque<std::function<void()>> jobs;
+        };
+
+        void Run(size_t index) {
+            t_owner = this;
+            t_index = index;
+            std::function<void()> job;
+            for (;;) {
+                if (Take(index, job)) {
+                    job();
+                    job = nullptr;
+                    continue;
+                }
+                std::unique_lock lock(m_sleep_mutex);
+                m_wake.wait(lock, [&] { return m_stop || m_pending.load(std::memory_order_acquire) > 0; });
+                if (m_stop && m_pending.load(std::memory_order_acquire) == 0) return;
+            }
+        }
+
+        bool Take(size_t index, std::function<void()>& job) {
+            for (size_t k = 0; k < m_queues.size(); ++k) {
+                Queue& queue = m_queues[(index + k) % m_queues.size()];
+                std::lock_guard lock(queue.mutex);
+                if (queue.jobs.empty()) continue;
+                if (k == 0) {
+                    job = std::move(queue.jobs.back());
+                    queue.jobs.pop_back();
+                }
+                else {
+                    job = std::move(queue.jobs.front());
+                    queue.jobs.pop_front();
+                }
+                m_pending.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+            return false;
+        }
+
+        static void Pin(std::thread& thread, uint32_t cpu) {
+#if defined(_WIN32)
+            if (cpu < sizeof(DWORD_PTR) * 8) SetThreadAffinityMask(thread.native_handle(), DWORD_PTR(1) << cpu);
+#elif defined(__linux__)
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            if (cpu >= CPU_SETSIZE) return;
+            CPU_SET(cpu, &set);
+            pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+            (void)thread;
+            (void)cpu;
+#endif
+        }
+
+        static inline thread_local const WorkStealingScheduler* t_owner = nullptr;
+        static inline thread_local size_t t_index = 0;
+
+        std::vector<Queue> m_queues;
+        std::vector<std::thread> m_threads;
+        std::atomic<size_t> m_next{ 0 };
+        std::atomic<size_t> m_pending{ 0 };
+        std::mutex m_sleep_mutex;
+        std::condition_variable m_wake;
+        bool m_stop{ false };
+    };
+
+    namespace parallel {
+        unsigned ResolveThreads(uint32_t requested) {
+            if (requested != 0) return requested;
+            unsigned hw = std::thread::hardware_concurrency();
+            return hw != 0 ? hw : 1;
+        }
+
+        // Runs fn(0..count-1) on the calling thread plus jobs on jobs, or only the calling thread without.
+        // The caller claims indices as well and waits only for ones already claimed, so a job that starts
+        // late finds nothing left: nested loops and busy or inline job systems cannot stall it.
+        void For(JobSystem* jobs, size_t count, const std::function<void(size_t)>& fn) {
+            if (count == 0) return;
+            size_t helpers = jobs ? std::min<size_t>(jobs->Concurrency(), count - 1) : 0;
+            if (helpers == 0) {
+                for (size_t i = 0; i < count; ++i) fn(i);
+                return;
+            }
+            struct Loop {
+                std::atomic<size_t> next{ 0 };
+                std::atomic<size_t> done{ 0 };
+                size_t count{ 0 };
+                const std::function<void(size_t)>* fn{ nullptr };
+                std::mutex mutex;
+                std::condition_variable finished;
+
+                void Run() {
+                    for (size_t i = next++; i < count; i = next++) {
+                        (*fn)(i);
+                        if (done.fetch_add(1, std::memory_order_acq_rel) + 1 == count) {
+                            std::lock_guard lock(mutex);
+                            finished.notify_all();
+                        }
+                    }
+                }
+            };
+            auto loop = std::make_shared<Loop>();
+            loop->count = count;
+            loop->fn = &fn;
+            for (size_t h = 0; h < helpers; ++h) jobs->Submit([loop] { loop->Run(); });
+            loop->Run();
+            std::unique_lock lock(loop->mutex);
+            loop->finished.wait(lock, [&] { return loop->done.load(std::memory_order_acquire) == count; });
+        }
+    }
+
+    // Large entries are stored as independent zlib blocks so they can be inflated concurrently.
+    // Layout: [block_size][block_count][compressed size per block...][block data...]
+    namespace chunked {
+        constexpr size_t HEADER_SIZE = sizeof(uint32_t) * 2;
+
+        struct Layout {
+            uint32_t block_size{ 0 };
+            std::vector<uint32_t> sizes;
+            std::vector<size_t> offsets;
+        };
+
+        bool ParseLayout(const uint8_t* data, size_t size, uint32_t uncompressed_size, Layout& layout) {
+            if (size < HEADER_SIZE) return false;
+            uint32_t count;
+            std::memcpy(&layout.block_size, data, sizeof(uint32_t));
+            std::memcpy(&count, data + sizeof(uint32_t), sizeof(uint32_t));
+            if (layout.block_size == 0) return false;
+            if (count != (static_cast<uint64_t>(uncompressed_size) + layout.block_size - 1) / layout.block_size) return false;
+            size_t table_end = HEADER_SIZE + static_cast<size_t>(count) * sizeof(uint32_t);
+            if (table_end > size) return false;
+            layout.sizes.resize(count);
+            layout.offsets.resize(count);
+            std::memcpy(layout.sizes.data(), data + HEADER_SIZE, count * sizeof(uint32_t));
+            size_t pos = table_end;
+            for (uint32_t i = 0; i < count; ++i) {
+                layout.offsets[i] = pos;
+                pos += layout.sizes[i];
+            }
+            return pos == size;
+        }
+    }
+
+    namespace hash {
+        uint32_t MurmurHash3(const void* key, size_t len, uint32_t seed = 0x52425061) {
+            if (!key || len == 0) return seed;
+            const uint8_t* data = static_cast<const uint8_t*>(key);
+            const int nblocks = static_cast<int>(len / 4);
+            uint32_t h1 = seed;
+            const uint32_t c1 = 0xcc9e2d51;
+            const uint32_t c2 = 0x1b873593;
+            const uint32_t* blocks = reinterpret_cast<const uint32_t*>(data + nblocks * 4);
+            for (int i = -nblocks; i; i++) {
+                uint32_t k1 = blocks[i];
+                k1 *= c1;
+                k1 = (k1 << 15) | (k1 >> 17);
+                k1 *= c2;
+                h1 ^= k1;
+                h1 = (h1 << 13) | (h1 >> 19);
+                h1 = h1 * 5 + 0xe6546b64;
+            }
+            const uint8_t* tail = data + nblocks * 4;
+            uint32_t k1 = 0;
+            switch (len & 3) {
+            case 3: k1 ^= tail[2] << 16; [[fallthrough]];
+            case 2: k1 ^= tail[1] << 8; [[fallthrough]];
+            case 1: k1 ^= tail[0];
+                k1 *= c1;
+                k1 = (k1 << 15) | (k1 >> 17);
+                k1 *= c2;
+                h1 ^= k1;
+            }
+            h1 ^= static_cast<uint32_t>(len);
+            h1 ^= h1 >> 16;
+            h1 *= 0x85ebca6b;
+            h1 ^= h1 >> 13;
+            h1 *= 0xc2b2ae35;
+            h1 ^= h1 >> 16;
+            return h1;
+        }
+
+        uint64_t Fnv1a64(const void* data, size_t size, uint64_t hash = 14695981039346656037ull) {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            for (size_t i = 0; i < size; ++i) {
+                hash ^= bytes[i];
+                hash *= 1099511628211ull;
+            }
+            return hash;
+        }
+
+        std::string Obfuscate(std::string_view name) {
+            uint32_t hash = MurmurHash3(name.data(), name.size());
+            return "rbp_" + std::to_string(hash) + ".dat";
+        }
+    }
+
+    class IOHelper {
+    public:
+        template<typename T>
+        static bool Write(std::ostream& stream, const T& value) {
+            return stream.write(reinterpret_cast<const char*>(&value), sizeof(T)).good();
+        }
+
+        template<typename T>
+        static bool Read(std::istream& stream, T& value) {
+            return stream.read(reinterpret_cast<char*>(&value), sizeof(T)).good();
+        }
+
+        static bool WriteString(std::ostream& stream, std::string_view str) {
+            if (str.size() > UINT16_MAX) return false;
+            uint16_t length = static_cast<uint16_t>(str.length());
+            if (!Write(stream, length)) return false;
+            return stream.write(str.data(), length).good();
+        }
+
+        template<typename String>
+        static bool ReadString(std::istream& stream, String& str) {
+            uint16_t length;
+            if (!Read(stream, length)) return false;
+            if (length > 8192) return false;
+            str.resize(length);
+            return stream.read(str.data(), length).good();
+        }
+    };
+
+    bool AccessPredictor::Save(std::ostream& stream) const {
+        std::lock_guard lock(m_mutex);
+        IOHelper::Write(stream, static_cast<uint32_t>(m_nodes.size()));
+        for (const auto& [name, node] : m_nodes) {
+            IOHelper::WriteString(stream, name);
+            IOHelper::Write(stream, node.total);
+            IOHelper::Write(stream, static_cast<uint8_t>(node.successors.size()));
+            for (const auto& successor : node.successors) {
+                IOHelper::WriteString(stream, successor.name);
+                IOHelper::Write(stream, successor.count);
+            }
+        }
+        return stream.good();
+    }
+
+    bool AccessPredictor::Load(std::istream& stream) {
+        uint32_t count = 0;
+        if (!IOHelper::Read(stream, count)) return false;
+        decltype(m_nodes) nodes;
+        for (uint32_t i = 0; i < count; ++i) {
+            std::string name;
+            Node node;
+            uint8_t successors = 0;
+            if (!IOHelper::ReadString(stream, name) || !IOHelper::Read(stream, node.total) ||
+                !IOHelper::Read(stream, successors) || successors > MAX_SUCCESSORS) {
+                return false;
+            }
+            node.successors.resize(successors);
+            for (auto& successor : node.successors) {
+                if (!IOHelper::ReadString(stream, successor.name) || !IOHelper::Read(stream, successor.count)) return false;
+            }
+            nodes.insert_or_assign(std::move(name), std::move(node));
+        }
+        std::lock_guard lock(m_mutex);
+        m_nodes = std::move(nodes);
+        return true;
+    }
+
+    // Positional reads, so concurrent readers share no file offset. Read additionally detects callers
+    // walking the file in offset order and serves them from growing read-ahead windows; its bookkeeping
+    // is atomic, and only the reader refilling the window takes a lock while the others read around it.
+    class FileReader {
+    public:
+        enum class Advice { Normal, Sequential, WillNeed, DontNeed };
+
+        // Windows are allocated from resource
+        static std::unique_ptr<FileReader> Open(const fs::path& path, size_t max_read_ahead = 0,
+            std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+            auto reader = std::unique_ptr<FileReader>(new FileReader());
+            reader->m_resource = resource;
+            reader->m_max_window = max_read_ahead;
+            reader->m_window_size.store(std::min(MIN_WINDOW, max_read_ahead), std::memory_order_relaxed);
+#if defined(_WIN32)
+            reader->m_handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (reader->m_handle == INVALID_HANDLE_VALUE) return nullptr;
+            LARGE_INTEGER size{};
+            if (!GetFileSizeEx(reader->m_handle, &size)) return nullptr;
+            reader->m_size = static_cast<uint64_t>(size.QuadPart);
+#else
+            reader->m_fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (reader->m_fd < 0) return nullptr;
+            struct stat info {};
+            if (fstat(reader->m_fd, &info) != 0) return nullptr;
+            reader->m_size = static_cast<uint64_t>(info.st_size);
+#endif
+            return reader;
+        }
+
+        ~FileReader() {
+#if defined(_WIN32)
+            if (m_handle != INVALID_HANDLE_VALUE) CloseHandle(m_handle);
+#else
+            if (m_fd >= 0) ::close(m_fd);
+#endif
+        }
+
+        FileReader(const FileReader&) = delete;
+        FileReader& operator=(const FileReader&) = delete;
+
+        uint64_t Size() const noexcept { return m_size; }
+
+        bool ReadAt(uint64_t offset, uint8_t* dst, size_t size) const {
+            while (size > 0) {
+#if defined(_WIN32)
+                OVERLAPPED overlapped{};
+                overlapped.Offset = static_cast<DWORD>(offset);
+                overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+                DWORD read = 0;
+                DWORD request = static_cast<DWORD>(std::min<size_t>(size, 1u << 30));
+                if (!ReadFile(m_handle, dst, request, &read, &overlapped) || read == 0) return false;
+#else
+                ssize_t read = ::pread(m_fd, dst, size, static_cast<off_t>(offset));
+                if (read < 0 && errno == EINTR) continue;
+                if (read <= 0) return false;
+#endif
+                dst += read;
+                offset += static_cast<uint64_t>(read);
+                size -= static_cast<size_t>(read);
+            }
+            return true;
+        }
+
+        // Same as ReadAt, but a run of forward reads switches to read-ahead: the window starts at
+        // MIN_WINDOW and doubles per refill up to max_read_ahead, and the OS is told to stream the file
+        bool Read(uint64_t offset, uint8_t* dst, size_t size) {
+            if (m_max_window == 0) return ReadAt(offset, dst, size);
+            // Concurrent callers may interleave these updates; the streak is a heuristic, not an invariant
+            uint64_t expected = m_next.exchange(offset + size, std::memory_order_relaxed);
+            unsigned streak = 0;
+            if (offset >= expected && offset - expected <= SEQUENTIAL_GAP) {
+                streak = m_streak.fetch_add(1, std::memory_order_relaxed) + 1;
+                if (streak == SEQUENTIAL_STREAK) Advise(Advice::Sequential, 0, 0);
+            }
+            else if (m_streak.exchange(0, std::memory_order_relaxed) >= SEQUENTIAL_STREAK) {
+                m_window_size.store(std::min(MIN_WINDOW, m_max_window), std::memory_order_relaxed);
+                Advise(Advice::Normal, 0, 0);
+            }
+
+            WindowPtr window = m_window.load(std::memory_order_acquire);
+            if (window && window->Covers(offset, size)) {
+                std::copy_n(window->data.data() + (offset - window->offset), size, dst);
+                return true;
+            }
+            if (streak < SEQUENTIAL_STREAK || offset >= m_size) return ReadAt(offset, dst, size);
+            // One reader refills; the others read directly instead of waiting for it
+            std::unique_lock fill_lock(m_fill_mutex, std::try_to_lock);
+            if (!fill_lock) return ReadAt(offset, dst, size);
+            size_t window_size = m_window_size.load(std::memory_order_relaxed);
+            size_t fill = static_cast<size_t>(std::min<uint64_t>(window_size, m_size - offset));
+            if (fill <= size) return ReadAt(offset, dst, size);
+
+            auto next = std::allocate_shared<Window>(std::pmr::polymorphic_allocator<Window>(m_resource), m_resource);
+            next->offset = offset;
+            next->data.resize(fill);
+            if (!ReadAt(offset, next->data.data(), fill)) return ReadAt(offset, dst, size);
+            std::copy_n(next->data.data(), size, dst);
+            m_window_size.store(std::min(window_size * 2, m_max_window), std::memory_order_relaxed);
+            m_window.store(std::move(next), std::memory_order_release);
+            // Let the kernel fetch the following window while the caller consumes this one
+            Advise(Advice::WillNeed, offset + fill, std::min<uint64_t>(fill * 2ull, m_max_window));
+            return true;
+        }
+
+        // Page cache hint for [offset, offset + length), length 0 meaning to the end of the file.
+        // false where the platform has no equivalent.
+        bool Advise(Advice advice, uint64_t offset, uint64_t length) const {
+#if defined(POSIX_FADV_WILLNEED)
+            int native = POSIX_FADV_NORMAL;
+            switch (advice) {
+            case Advice::Normal: native = POSIX_FADV_NORMAL; break;
+            case Advice::Sequential: native = POSIX_FADV_SEQUENTIAL; break;
+            case Advice::WillNeed: native = POSIX_FADV_WILLNEED; break;
+            case Advice::DontNeed: native = POSIX_FADV_DONTNEED; break;
+            }
+            return posix_fadvise(m_fd, static_cast<off_t>(offset), static_cast<off_t>(length), native) == 0;
+#else
+            (void)advice;
+            (void)offset;
+            (void)length;
+            return false;
+#endif
+        }
+
+        // Drops the read-ahead window
+        void Reset() {
+            std::lock_guard lock(m_fill_mutex);
+            m_window.store(nullptr, std::memory_order_release);
+            m_streak.store(0, std::memory_order_relaxed);
+            m_window_size.store(std::min(MIN_WINDOW, m_max_window), std::memory_order_relaxed);
+        }
+
+    private:
+        static constexpr size_t MIN_WINDOW = 256 * 1024;
+        static constexpr uint64_t SEQUENTIAL_GAP = 64 * 1024; // Skipped bytes still counted as a forward read
+        static constexpr unsigned SEQUENTIAL_STREAK = 3;
+
+        struct Window {
+            explicit Window(std::pmr::memory_resource* resource) : data(resource) {}
+
+            uint64_t offset{ 0 };
+            Blob data;
+
+            bool Covers(uint64_t start, size_t size) const noexcept {
+                return start >= offset && start + size <= offset + data.size();
+            }
+        };
+        using WindowPtr = std::shared_ptr<const Window>;
+
+        FileReader() = default;
+
+#if defined(_WIN32)
+        HANDLE m_handle{ INVALID_HANDLE_VALUE };
+#else
+        int m_fd{ -1 };
+#endif
+        uint64_t m_size{ 0 };
+        size_t m_max_window{ 0 };
+        std::pmr::memory_resource* m_resource{ nullptr };
+        std::mutex m_fill_mutex;
+        std::atomic<WindowPtr> m_window;
+        std::atomic<uint64_t> m_next{ 0 };
+        std::atomic<unsigned> m_streak{ 0 };
+        std::atomic<size_t> m_window_size{ MIN_WINDOW };
+    };
+
+    // Read-only memory mapping of a whole file
+    class MappedFile {
+    public:
+        static std::unique_ptr<MappedFile> Open(const fs::path& path) {
+            auto mapped = std::unique_ptr<MappedFile>(new MappedFile());
+#if defined(_WIN32)
+            HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE) return nullptr;
+            LARGE_INTEGER size{};
+            if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+                CloseHandle(file);
+                return nullptr;
+            }
+            HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            CloseHandle(file);
+            if (!mapping) return nullptr;
+            mapped->m_data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            CloseHandle(mapping);
+            if (!mapped->m_data) return nullptr;
+            mapped->m_size = static_cast<size_t>(size.QuadPart);
+#elif defined(__unix__) || defined(__APPLE__)
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) return nullptr;
+            struct stat info {};
+            if (fstat(fd, &info) != 0 || info.st_size == 0) {
+                ::close(fd);
+                return nullptr;
+            }
+            void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (data == MAP_FAILED) return nullptr;
+            mapped->m_data = static_cast<const uint8_t*>(data);
+            mapped->m_size = static_cast<size_t>(info.st_size);
+#else
+            (void)path;
+            return nullptr;
+#endif
+            return mapped;
+        }
+
+        ~MappedFile() {
+            if (!m_data) return;
+#if defined(_WIN32)
+            UnmapViewOfFile(m_data);
+#elif defined(__unix__) || defined(__APPLE__)
+            munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const uint8_t* Data() const noexcept { return m_data; }
+        size_t Size() const noexcept { return m_size; }
+
+    private:
+        MappedFile() = default;
+
+        const uint8_t* m_data{ nullptr };
+        size_t m_size{ 0 };
+    };
+
+    // Decoded entries shared by every process on the host that attaches the same segment name.
+    // Data lives in a ring; writers serialize on a robust process-shared mutex, readers never lock
+    // and instead validate their copy against the slot sequence and the ring tail (seqlock style).
+    class SharedCache {
+    public:
+#if defined(__linux__)
+        static std::unique_ptr<SharedCache> Attach(const std::string& name, size_t capacity) {
+            static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared cache needs address-free atomics");
+            if (name.empty() || capacity < MIN_CAPACITY) return nullptr;
+            std::string shm_name = name.front() == '/' ? name : "/" + name;
+            bool abandoned = false;
+            auto cache = Open(shm_name, capacity, abandoned);
+            // The segment a dead creator left behind has been unlinked; this process creates it afresh
+            if (!cache && abandoned) cache = Open(shm_name, capacity, abandoned);
+            return cache;
+        }
+
+        ~SharedCache() {
+            if (m_base) munmap(m_base, m_mapped_size);
+        }
+
+        bool Read(uint64_t key, uint8_t* dst, size_t size, uint32_t crc) const {
+            const uint64_t capacity = m_header->capacity;
+            if (size == 0 || size > capacity) return false;
+            for (size_t probe = 0; probe < PROBE_LENGTH; ++probe) {
+                const Slot& slot = m_slots[(key + probe) % m_header->slot_count];
+                uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+                if (sequence == 0 || (sequence & 1) || slot.key.load(std::memory_order_relaxed) != key) continue;
+                uint64_t offset = slot.offset.load(std::memory_order_relaxed);
+                if (slot.size.load(std::memory_order_relaxed) != size || slot.crc32.load(std::memory_order_relaxed) != crc ||
+                    offset < m_header->tail.load(std::memory_order_acquire)) {
+                    return false;
+                }
+                std::memcpy(dst, m_data + offset % capacity, size);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                // A writer that recycled the slot or wrapped over the bytes makes the copy invalid
+                return slot.sequence.load(std::memory_order_relaxed) == sequence &&
+                    m_header->tail.load(std::memory_order_relaxed) <= offset;
+            }
+            return false;
+        }
+
+        // True when the segment holds the entry afterwards, whether written now or already there
+        bool Write(uint64_t key, const uint8_t* data, size_t size, uint32_t crc) {
+            const uint64_t capacity = m_header->capacity;
+            if (size == 0 || size > capacity / 4) return false;
+            RobustLock lock(&m_header->mutex);
+            if (!lock) return false;
+
+            uint64_t tail = m_header->tail.load(std::memory_order_relaxed);
+            Slot* target = nullptr;
+            uint64_t oldest = UINT64_MAX;
+            for (size_t probe = 0; probe < PROBE_LENGTH; ++probe) {
+                Slot& slot = m_slots[(key + probe) % m_header->slot_count];
+                uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+                uint64_t offset = slot.offset.load(std::memory_order_relaxed);
+                bool live = sequence != 0 && !(sequence & 1) && offset >= tail;
+                if (live && slot.key.load(std::memory_order_relaxed) == key) {
+                    if (slot.size.load(std::memory_order_relaxed) == size && slot.crc32.load(std::memory_order_relaxed) == crc) return true;
+                    target = &slot;
+                    break;
+                }
+                uint64_t age = live ? offset : 0;
+                if (age < oldest) {
+                    oldest = age;
+                    target = &slot;
+                }
+            }
+
+            uint64_t head = m_header->head.load(std::memory_order_relaxed);
+            if (head % capacity + size > capacity) head += capacity - head % capacity;
+            uint64_t end = head + size;
+            if (end > capacity && end - capacity > tail) {
+                m_header->tail.store(end - capacity, std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_release);
+            std::memcpy(m_data + head % capacity, data, size);
+
+            uint64_t sequence = target->sequence.load(std::memory_order_relaxed) | 1;
+            target->sequence.store(sequence, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            target->key.store(key, std::memory_order_relaxed);
+            target->offset.store(head, std::memory_order_relaxed);
+            target->size.store(static_cast<uint32_t>(size), std::memory_order_relaxed);
+            target->crc32.store(crc, std::memory_order_relaxed);
+            target->sequence.store(sequence + 1, std::memory_order_release);
+            m_header->head.store(end, std::memory_order_relaxed);
+            return true;
+        }
+#else
+        // Needs robust process-shared mutexes; other platforms keep per-process caching only
+        static std::unique_ptr<SharedCache> Attach(const std::string&, size_t) { return nullptr; }
+        bool Read(uint64_t, uint8_t*, size_t, uint32_t) const { return false; }
+        bool Write(uint64_t, const uint8_t*, size_t, uint32_t) { return false; }
+#endif
+
+        SharedCache(const SharedCache&) = delete;
+        SharedCache& operator=(const SharedCache&) = delete;
+
+    private:
+        SharedCache() = default;
+
+#if defined(__linux__)
+        static constexpr uint32_t MAGIC = 0x43534252; // "RBSC"
+        static constexpr size_t MIN_CAPACITY = 1024 * 1024;
+        static constexpr size_t MIN_SLOTS = 256;
+        static constexpr size_t BYTES_PER_SLOT = 16 * 1024;
+        static constexpr size_t PROBE_LENGTH = 8;
+        static constexpr int ATTACH_ATTEMPTS = 100;
+
+        // Offsets are absolute ring positions; anything below tail has been overwritten
+        struct alignas(64) Header {
+            std::atomic<uint32_t> ready;
+            uint64_t capacity;
+            uint64_t slot_count;
+            std::atomic<uint64_t> head;
+            std::atomic<uint64_t> tail;
+            pthread_mutex_t mutex;
+        };
+
+        // sequence is 0 when empty and odd while a writer owns the slot
+        struct Slot {
+            std::atomic<uint64_t> sequence;
+            std::atomic<uint64_t> key;
+            std::atomic<uint64_t> offset;
+            std::atomic<uint32_t> size;
+            std::atomic<uint32_t> crc32;
+        };
+
+        class RobustLock {
+        public:
+            explicit RobustLock(pthread_mutex_t* mutex) : m_mutex(mutex) {
+                int rc = pthread_mutex_lock(mutex);
+                // A writer died holding the lock; its half-written slot still has an odd sequence
+                if (rc == EOWNERDEAD) rc = pthread_mutex_consistent(mutex);
+                m_locked = rc == 0;
+            }
+            ~RobustLock() {
+                if (m_locked) pthread_mutex_unlock(m_mutex);
+            }
+            explicit operator bool() const { return m_locked; }
+
+        private:
+            pthread_mutex_t* m_mutex;
+            bool m_locked{ false };
+        };
+
+        static size_t DataOffset(size_t slot_count) {
+            return (sizeof(Header) + slot_count * sizeof(Slot) + 63) & ~size_t(63);
+        }
+
+        struct Descriptor {
+            int fd;
+            ~Descriptor() {
+                if (fd >= 0) ::close(fd);
+            }
+        };
+
+        // The creator holds an exclusive flock on the segment until it is ready, and the kernel drops it if the
+        // creator dies. A follower that gives up waiting and can take that lock has found an abandoned segment.
+        static std::unique_ptr<SharedCache> Open(const std::string& shm_name, size_t capacity, bool& abandoned) {
+            abandoned = false;
+            size_t slot_count = std::max<size_t>(MIN_SLOTS, capacity / BYTES_PER_SLOT);
+            size_t total = DataOffset(slot_count) + capacity;
+
+            Descriptor file{ shm_open(shm_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600) };
+            bool creator = file.fd >= 0;
+            if (!creator) {
+                if (errno != EEXIST) return nullptr;
+                file.fd = shm_open(shm_name.c_str(), O_RDWR, 0);
+                if (file.fd < 0) return nullptr;
+            }
+            if (creator && (flock(file.fd, LOCK_EX) != 0 || ftruncate(file.fd, static_cast<off_t>(total)) != 0)) {
+                shm_unlink(shm_name.c_str());
+                return nullptr;
+            }
+            if (!creator) {
+                // The creator may still be sizing the segment; its geometry wins over ours
+                struct stat info {};
+                for (int attempt = 0; attempt < ATTACH_ATTEMPTS; ++attempt) {
+                    if (fstat(file.fd, &info) == 0 && static_cast<size_t>(info.st_size) > sizeof(Header)) break;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+                total = static_cast<size_t>(info.st_size);
+                if (total <= sizeof(Header)) {
+                    abandoned = RemoveAbandoned(file.fd, shm_name);
+                    return nullptr;
+                }
+            }
+            void* base = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, file.fd, 0);
+            if (base == MAP_FAILED) return nullptr;
+
+            auto cache = std::unique_ptr<SharedCache>(new SharedCache());
+            cache->m_base = static_cast<uint8_t*>(base);
+            cache->m_mapped_size = total;
+            cache->m_header = static_cast<Header*>(base);
+            if (creator) {
+                pthread_mutexattr_t attr;
+                pthread_mutexattr_init(&attr);
+                pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+                pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+                pthread_mutex_init(&cache->m_header->mutex, &attr);
+                pthread_mutexattr_destroy(&attr);
+                cache->m_header->capacity = capacity;
+                cache->m_header->slot_count = slot_count;
+                cache->m_header->ready.store(MAGIC, std::memory_order_release);
+            }
+            else {
+                int attempt = 0;
+                while (cache->m_header->ready.load(std::memory_order_acquire) != MAGIC) {
+                    if (++attempt == ATTACH_ATTEMPTS) {
+                        abandoned = RemoveAbandoned(file.fd, shm_name, cache->m_header);
+                        if (abandoned || cache->m_header->ready.load(std::memory_order_acquire) != MAGIC) return nullptr;
+                        break;
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+                if (DataOffset(cache->m_header->slot_count) + cache->m_header->capacity > total) return nullptr;
+            }
+            cache->m_slots = reinterpret_cast<Slot*>(cache->m_base + sizeof(Header));
+            cache->m_data = cache->m_base + DataOffset(cache->m_header->slot_count);
+            return cache;
+        }
+
+        // Unlinks the segment behind fd once its creator is gone, but only while the name still refers to it.
+        // Holding the flock keeps every other process out, so a segment created meanwhile is never removed.
+        static bool RemoveAbandoned(int fd, const std::string& shm_name, const Header* header = nullptr) {
+            if (flock(fd, LOCK_EX | LOCK_NB) != 0) return false;
+            // A creator that finished just before the lock was taken left a usable segment
+            if (header && header->ready.load(std::memory_order_acquire) == MAGIC) return false;
+            Descriptor current{ shm_open(shm_name.c_str(), O_RDWR, 0) };
+            struct stat ours {}, named {};
+            if (current.fd < 0 || fstat(fd, &ours) != 0 || fstat(current.fd, &named) != 0 ||
+                ours.st_dev != named.st_dev || ours.st_ino != named.st_ino) {
+                return false;
+            }
+            return shm_unlink(shm_name.c_str()) == 0;
+        }
+
+        uint8_t* m_base{ nullptr };
+        size_t m_mapped_size{ 0 };
+        Header* m_header{ nullptr };
+        Slot* m_slots{ nullptr };
+        uint8_t* m_data{ nullptr };
+#endif
+    };
+
+    // Watches OS memory-pressure signals on a background thread: PSI triggers on Linux (the cgroup's own
+    // memory.pressure when available) and the low-memory resource notification on Windows. The level
+    // drops back to None once no signal has fired for RECOVERY.
+    class MemoryPressureMonitor {
+    public:
+        using Callback = std::function<void(MemoryPressure)>;
+
+        static std::unique_ptr<MemoryPressureMonitor> Start(Callback callback) {
+            auto monitor = std::unique_ptr<MemoryPressureMonitor>(new MemoryPressureMonitor(std::move(callback)));
+            if (!monitor->Open()) return nullptr;
+            monitor->m_thread = std::thread([raw = monitor.get()] { raw->Run(); });
+            return monitor;
+        }
+
+        ~MemoryPressureMonitor() {
+#if defined(_WIN32)
+            if (m_stop) SetEvent(m_stop);
+            if (m_thread.joinable()) m_thread.join();
+            if (m_stop) CloseHandle(m_stop);
+            if (m_low_memory) CloseHandle(m_low_memory);
+#elif defined(__linux__)
+            if (m_wake[1] >= 0) {
+                char byte = 0;
+                [[maybe_unused]] auto written = ::write(m_wake[1], &byte, 1);
+            }
+            if (m_thread.joinable()) m_thread.join();
+            for (int fd : { m_some, m_full, m_wake[0], m_wake[1] }) {
+                if (fd >= 0) ::close(fd);
+            }
+#endif
+        }
+
+        MemoryPressureMonitor(const MemoryPressureMonitor&) = delete;
+        MemoryPressureMonitor& operator=(const MemoryPressureMonitor&) = delete;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+        static constexpr auto RECOVERY = std::chrono::seconds(10);
+
+        explicit MemoryPressureMonitor(Callback callback) : m_callback(std::move(callback)) {}
+
+#if defined(_WIN32)
+        bool Open() {
+            m_low_memory = CreateMemoryResourceNotification(LowMemoryResourceNotification);
+            m_stop = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+            return m_low_memory && m_stop;
+        }
+
+        void Run() {
+            MemoryPressure level = MemoryPressure::None;
+            Clock::time_point last_signal{};
+            HANDLE handles[] = { m_stop, m_low_memory };
+            for (;;) {
+                DWORD result = WaitForMultipleObjects(2, handles, FALSE, level == MemoryPressure::None ? INFINITE : 1000);
+                if (result != WAIT_OBJECT_0 + 1 && result != WAIT_TIMEOUT) break;
+                MemoryPressure next = level;
+                if (result == WAIT_OBJECT_0 + 1) {
+                    last_signal = Clock::now();
+                    next = MemoryPressure::Critical;
+                }
+                else if (Clock::now() - last_signal > RECOVERY) {
+                    next = MemoryPressure::None;
+                }
+                if (next != level) m_callback(level = next);
+                // The notification stays signaled while memory is low; pace the loop instead of spinning
+                if (result == WAIT_OBJECT_0 + 1 && WaitForSingleObject(m_stop, 1000) == WAIT_OBJECT_0) break;
+            }
+        }
+
+        HANDLE m_low_memory{ nullptr };
+        HANDLE m_stop{ nullptr };
+#elif defined(__linux__)
+        static std::string PressureFile() {
+            std::ifstream cgroup("/proc/self/cgroup");
+            std::string line;
+            while (std::getline(cgroup, line)) {
+                if (line.rfind("0::", 0) != 0) continue;
+                fs::path path = fs::path("/sys/fs/cgroup") / line.substr(3 + (line.size() > 3 && line[3] == '/')) / "memory.pressure";
+                std::error_code ec;
+                if (fs::exists(path, ec)) return path.string();
+            }
+            return "/proc/pressure/memory";
+        }
+
+        static int OpenTrigger(const std::string& path, const char* trigger) {
+            int fd = ::open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+            if (fd < 0) return -1;
+            if (::write(fd, trigger, std::strlen(trigger) + 1) < 0) {
+                ::close(fd);
+                return -1;
+            }
+            return fd;
+        }
+
+        bool Open() {
+            std::string path = PressureFile();
+            // Stall thresholds within a 2 s window, the smallest window unprivileged triggers accept
+            m_some = OpenTrigger(path, "some 150000 2000000");
+            m_full = OpenTrigger(path, "full 100000 2000000");
+            return (m_some >= 0 || m_full >= 0) && ::pipe2(m_wake, O_CLOEXEC) == 0;
+        }
+
+        void Run() {
+            MemoryPressure level = MemoryPressure::None;
+            Clock::time_point last_some = Clock::now() - 2 * RECOVERY;
+            Clock::time_point last_full = last_some;
+            pollfd fds[] = { { m_wake[0], POLLIN, 0 }, { m_some, POLLPRI, 0 }, { m_full, POLLPRI, 0 } };
+            for (;;) {
+                int ready = ::poll(fds, 3, level == MemoryPressure::None ? -1 : 1000);
+                if (ready < 0 && errno != EINTR) break;
+                if (fds[0].revents || (fds[1].revents | fds[2].revents) & POLLERR) break;
+                auto now = Clock::now();
+                if (fds[1].revents & POLLPRI) last_some = now;
+                if (fds[2].revents & POLLPRI) last_full = now;
+                MemoryPressure next = now - last_full < RECOVERY ? MemoryPressure::Critical
+                    : now - last_some < RECOVERY ? MemoryPressure::Moderate : MemoryPressure::None;
+                if (next != level) m_callback(level = next);
+            }
+        }
+
+        int m_some{ -1 };
+        int m_full{ -1 };
+        int m_wake[2]{ -1, -1 };
+#else
+        bool Open() { return false; }
+        void Run() {}
+#endif
+
+        Callback m_callback;
+        std::thread m_thread;
+    };
+
+    struct CachePolicy {
+        CachePriority priority{ CachePriority::Normal };
+        bool pinned{ false };
+    };
+
+    // A loaded package file, kept open for as long as any entry read from it is reachable
+    struct PackageFile {
+        std::unique_ptr<FileReader> reader;
+        std::string path;
+        uint64_t identity{ 0 }; // Hash of header and directory, names the file's disk and shared cache entries
+        uint64_t source{ 0 }; // Hash of the file's absolute path, shared by every version loaded from it
+    };
+
+    // One published version of the package index. Never changed once published: writers copy the current
+    // version, change the copy and swap it in, so a reader's snapshot stays valid without locks.
+    struct Directory {
+        explicit Directory(std::pmr::memory_resource* resource)
+            : entries(resource), bundles(resource), dependencies(resource) {}
+        Directory(const Directory& other, std::pmr::memory_resource* resource)
+            : entries(other.entries, resource), bundles(other.bundles, resource),
+            dependencies(other.dependencies, resource), file(other.file) {}
+
+        StringMap<std::shared_ptr<Entry>> entries;
+        StringMap<std::pmr::vector<std::pmr::string>> bundles;
+        StringMap<std::pmr::vector<std::pmr::string>> dependencies; // Keys of entries each one needs loaded alongside
+        std::shared_ptr<PackageFile> file;
+    };
+    using DirectoryPtr = std::shared_ptr<const Directory>;
+
+    class Package::Impl {
+    private:
+        static constexpr uint32_t SIGNATURE = 0x6B506252;
+        static constexpr uint32_t VERSION = 0x00030002;
+        static constexpr size_t MAX_INLINE_SIZE = 64 * 1024;
+        static constexpr uint32_t SECTIONS_VERSION = 0x00030001; // Extension sections follow the directory
+        static constexpr uint32_t SECTION_DEPENDENCIES = 0x53504544; // "DEPS"
+        static constexpr uint32_t SECTION_BUNDLES = 0x4C444E42; // "BNDL"
+        static constexpr uint32_t MODEL_SIGNATURE = 0x4D504252; // "RBPM"
+        static constexpr uint32_t MODEL_VERSION = 1;
+        static constexpr size_t PREFETCH_QUEUE_LIMIT = 32;
+        static constexpr uint32_t MANIFEST_SIGNATURE = 0x4D434252; // "RBCM"
+        static constexpr uint32_t MANIFEST_VERSION = 1;
+        static constexpr uint64_t COALESCE_GAP = 64 * 1024;
+        static constexpr uint64_t MAX_BATCH_READ = 8 * 1024 * 1024;
+        static constexpr uint64_t BUNDLE_BATCH_READ = 64 * 1024 * 1024;
+        static constexpr size_t MISS_RATIO_TRACKED_KEYS = 64 * 1024;
+        static constexpr uint64_t MISS_RATIO_MIN_ACCESSES = 1024;
+
+        PackageConfig m_config;
+        std::pmr::memory_resource* m_resource;
+        // Readers take the current version with one atomic load; writers serialise on m_write_mutex
+        std::atomic<DirectoryPtr> m_directory;
+        std::mutex m_write_mutex;
+        std::unique_ptr<Cipher> m_cipher;
+        StringMap<CachePolicy> m_cache_policies;
+        mutable std::mutex m_policy_mutex;
+        std::unique_ptr<SlabArena> m_cache_arena;
+        LRUCache<BlobPtr> m_cache;
+        LRUCache<BlobPtr> m_compressed_cache;
+        std::mutex m_load_mutex; // Serialises first decodes of eager entries
+        BufferPool m_buffer_pool;
+        ByteCredit m_inflight; // Shared by all bulk operations, so running several does not multiply the budget
+        std::unique_ptr<SharedCache> m_shared_cache;
+        // Disk cache files opened so far stay mapped, so a hit is one copy out of the page cache
+        std::unordered_map<std::string, std::shared_ptr<const MappedFile>> m_disk_mappings;
+        uint64_t m_disk_cache_used{ 0 }; // Bytes the loaded package's disk cache directory holds
+        std::mutex m_disk_cache_mutex;
+        mutable std::atomic<PackageError> m_last_error{ PackageError::None };
+
+        // Bumped whenever cached data may be stale; read-mostly, so kept on its own cache line
+        alignas(64) std::atomic<uint64_t> m_generation{ 1 };
+        // Bumped after anything is dropped from the cache as stale, so front caches never keep such a blob.
+        // Kept apart from m_generation so retiring front caches does not make other inserts look stale.
+        std::atomic<uint64_t> m_front_epoch{ 1 };
+        const uint64_t m_id{ NextPackageId() };
+        std::vector<std::shared_ptr<FrontCache>> m_front_caches;
+        std::mutex m_front_mutex;
+
+        size_t m_cache_capacity; // Requested capacity, before any memory-pressure reduction
+        MemoryPressure m_pressure{ MemoryPressure::None };
+        mutable std::mutex m_pressure_mutex;
+        std::unique_ptr<MissRatioCurve> m_miss_ratio;
+        std::thread m_warm_thread;
+        std::atomic<bool> m_warm_cancel{ false };
+        std::mutex m_warm_mutex; // Guards m_warm_thread, so starting and waiting may come from any thread
+
+        // Started on first use, so packages that never run bulk work start no threads
+        mutable std::shared_ptr<JobSystem> m_jobs;
+        mutable std::once_flag m_jobs_once;
+
+        std::unique_ptr<AccessPredictor> m_predictor;
+        std::mutex m_prefetch_mutex;
+        std::condition_variable m_prefetch_cv;
+        std::deque<std::pair<std::shared_ptr<Entry>, uint64_t>> m_prefetch_queue; // With the generation it was found at
+        std::unordered_map<std::string, size_t, StringHash, std::equal_to<>> m_prefetched; // Not yet requested
+        size_t m_prefetched_bytes{ 0 };
+        bool m_prefetch_busy{ false };
+        bool m_prefetch_draining{ false }; // A drain job is submitted or running
+        double m_prefetch_tokens{ 0.0 }; // Token bucket for prefetch_bytes_per_second, never below zero
+        std::chrono::steady_clock::time_point m_prefetch_refilled{ std::chrono::steady_clock::now() };
+        std::chrono::steady_clock::time_point m_prefetch_due{}; // When the throttled queue head can be afforded
+        bool m_prefetch_throttled{ false }; // The last drain stopped short of tokens; the timer resumes it at m_prefetch_due
+        std::thread m_prefetch_timer; // Started the first time a drain is throttled
+        bool m_prefetch_stop{ false };
+        PrefetchStats m_prefetch_stats;
+        std::unique_ptr<MemoryPressureMonitor> m_pressure_monitor;
+
+    public:
+        explicit Impl(const PackageConfig& config) : m_config(config),
+            m_resource(config.memory_resource ? config.memory_resource : std::pmr::get_default_resource()),
+            m_directory(NewDirectory()),
+            m_cache_policies(m_resource),
+            m_cache_arena(config.cache_storage == CacheStorage::Arena && config.max_cache_size > 0
+                ? std::make_unique<SlabArena>(config.max_cache_size, config.cache_huge_pages) : nullptr),
+            m_cache(config.max_cache_size, m_cache_arena ? m_cache_arena.get() : m_resource, config.pinned_cache_size),
+            m_compressed_cache(config.compressed_cache_size, m_resource),
+            m_buffer_pool(config.buffer_pool_size, m_resource),
+            m_inflight(config.max_inflight_bytes),
+            m_shared_cache(SharedCache::Attach(config.shared_cache_name, config.shared_cache_size)),
+            m_cache_capacity(config.max_cache_size) {
+            if (m_config.encryption != EncryptionMethod::None && !m_config.encryption_key.empty()) {
+                m_cipher = std::make_unique<Cipher>(m_config.encryption_key);
+            }
+            if (m_config.track_miss_ratio) {
+                m_miss_ratio = std::make_unique<MissRatioCurve>(m_config.miss_ratio_sample_rate, MISS_RATIO_TRACKED_KEYS);
+            }
+            if (m_config.enable_prefetch && m_config.lazy_load) {
+                m_predictor = std::make_unique<AccessPredictor>();
+                m_prefetch_tokens = static_cast<double>(m_config.prefetch_bytes_per_second);
+            }
+            if (m_config.monitor_memory_pressure) {
+                m_pressure_monitor = MemoryPressureMonitor::Start([this](MemoryPressure level) { OnMemoryPressure(level); });
+            }
+        }
+
+        ~Impl() {
+            m_pressure_monitor.reset();
+            StopWarmup();
+            {
+                std::unique_lock lock(m_prefetch_mutex);
+                m_prefetch_stop = true;
+                m_prefetch_cv.notify_all();
+                m_prefetch_cv.wait(lock, [&] { return !m_prefetch_draining; });
+            }
+            if (m_prefetch_timer.joinable()) m_prefetch_timer.join();
+            m_jobs.reset();
+            std::lock_guard lock(m_front_mutex);
+            for (auto& front : m_front_caches) front->Release();
+        }
+
+        PackageResult Add(std::string_view name, const uint8_t* data, size_t size) {
+            std::shared_ptr<Entry> entry;
+            if (auto result = MakeEntry(name, data, size, entry); !result) return result;
+            Publish({ std::move(entry) });
+            return PackageResult::Success();
+        }
+
+        PackageResult AddFromFile(std::string_view name, std::string_view filepath) {
+            std::shared_ptr<Entry> entry;
+            if (auto result = MakeEntryFromFile(name, filepath, entry); !result) return result;
+            Publish({ std::move(entry) });
+            return PackageResult::Success();
+        }
+
+        PackageResult AddDirectory(std::string_view directory, bool recursive, ProgressCallback callback) {
+            std::string dir_str(directory);
+            if (!fs::exists(dir_str) || !fs::is_directory(dir_str)) {
+                return PackageResult::Failure(PackageError::FileNotFound, "Directory not found");
             }
             try {
                 std::vector<fs::path> files;
@@ -303,269 +2610,1936 @@ namespace rbpak {
                         if (entry.is_regular_file()) files.push_back(entry.path());
                     }
                 }
-                else {
-                    for (const auto& entry : fs::directory_iterator(dir_str)) {
-                        if (entry.is_regular_file()) files.push_back(entry.path());
+                else {
+                    for (const auto& entry : fs::directory_iterator(dir_str)) {
+                        if (entry.is_regular_file()) files.push_back(entry.path());
+                    }
+                }
+                // Files are read and checksummed on the job system, then published together in listing order
+                size_t current = 0;
+                std::mutex progress_mutex;
+                std::vector<std::shared_ptr<Entry>> added(files.size());
+                parallel::For(&Jobs(), files.size(), [&](size_t i) {
+                    std::error_code error;
+                    std::string relative = fs::relative(files[i], dir_str, error).string();
+                    if (callback) {
+                        std::lock_guard lock(progress_mutex);
+                        callback(current++, files.size(), relative);
+                    }
+                    size_t size = error ? 0 : static_cast<size_t>(fs::file_size(files[i], error));
+                    auto credit = m_inflight.Acquire(error ? 0 : BufferPool::Footprint(size)); // For the staging copy of the file
+                    if (error || !MakeEntryFromFile(relative, files[i].string(), added[i])) {
+                        added[i].reset();
+                        std::lock_guard lock(progress_mutex);
+                        std::cerr << "Failed to add: " << relative << std::endl;
+                    }
+                });
+                std::erase(added, nullptr);
+                Publish(std::move(added));
+                return PackageResult::Success();
+            }
+            catch (const std::exception& e) {
+                return PackageResult::Failure(PackageError::IOError, e.what());
+            }
+        }
+
+        // Entries before a failing one are still added
+        PackageResult AddMultiple(const std::vector<std::pair<std::string, ByteArray>>& files, ProgressCallback callback) {
+            size_t current = 0;
+            std::vector<std::shared_ptr<Entry>> added;
+            for (const auto& [name, data] : files) {
+                if (callback) callback(current++, files.size(), name);
+                std::shared_ptr<Entry> entry;
+                if (auto result = MakeEntry(name, data.data(), data.size(), entry); !result) {
+                    Publish(std::move(added));
+                    return result;
+                }
+                added.push_back(std::move(entry));
+            }
+            Publish(std::move(added));
+            return PackageResult::Success();
+        }
+
+        std::optional<ByteArray> Get(std::string_view name) {
+            if (m_miss_ratio) TrackAccess(name);
+            if (m_predictor) Predict(name);
+            FrontCache* front = LocalFrontCache();
+            uint64_t generation = m_generation.load(std::memory_order_acquire);
+            uint64_t epoch = m_front_epoch.load(std::memory_order_acquire);
+            std::optional<ByteArray> result;
+            if (front && front->Read(name, epoch, [&](const Blob& blob) { result.emplace(blob.begin(), blob.end()); })) {
+                return result;
+            }
+            if (auto cached = m_cache.Get(name)) {
+                if (front) front->Put(name, *cached, epoch);
+                return ByteArray((*cached)->begin(), (*cached)->end());
+            }
+            DirectoryPtr directory = Snapshot();
+            auto it = directory->entries.find(name);
+            if (it == directory->entries.end()) return std::nullopt;
+            Entry* entry = it->second.get();
+            if (!m_config.lazy_load) {
+                if (!LoadEntry(entry)) return std::nullopt;
+                return ByteArray(entry->data->begin(), entry->data->end());
+            }
+            // Lazy entries read from disk live only in the cache, not in the entry itself, and entries the
+            // shared segment holds are copied out of it on every miss instead of being cached per process
+            bool shared = false;
+            if (entry->IsLoaded()) {
+                result.emplace(entry->data->begin(), entry->data->end());
+            }
+            else {
+                result.emplace(entry->uncompressed_size);
+                if (!ReadEntry(entry, result->data(), &shared)) return std::nullopt;
+            }
+            if (shared) return result;
+            BlobPtr blob = CacheInsert(name, result->data(), result->size(), generation);
+            if (front && blob) front->Put(name, std::move(blob), epoch);
+            return result;
+        }
+
+        std::optional<size_t> GetSize(std::string_view name) const {
+            DirectoryPtr directory = Snapshot();
+            auto it = directory->entries.find(name);
+            if (it == directory->entries.end()) return std::nullopt;
+            return it->second->uncompressed_size;
+        }
+
+        PackageResult GetInto(std::string_view name, std::span<uint8_t> dest, bool cache) {
+            uint64_t generation = m_generation.load(std::memory_order_acquire);
+            uint64_t epoch = m_front_epoch.load(std::memory_order_acquire);
+            DirectoryPtr directory = Snapshot();
+            auto it = directory->entries.find(name);
+            if (it == directory->entries.end()) return PackageResult::Failure(PackageError::FileNotFound, "File not found");
+            Entry* entry = it->second.get();
+            if (dest.size() < entry->uncompressed_size) {
+                return PackageResult::Failure(PackageError::InvalidParameter, "Destination buffer too small");
+            }
+            if (m_miss_ratio && cache) TrackAccess(name);
+            if (m_predictor) Predict(name);
+            FrontCache* front = LocalFrontCache();
+            auto copy_out = [&](const Blob& data) { std::copy(data.begin(), data.end(), dest.begin()); };
+            if (front && front->Read(name, epoch, copy_out)) return PackageResult::Success();
+            bool cached = m_cache.Read(name, [&](const BlobPtr& data) {
+                copy_out(*data);
+                if (front) front->Put(name, data, epoch);
+            });
+            if (cached) return PackageResult::Success();
+            bool shared = false;
+            if (entry->IsLoaded()) {
+                std::copy(entry->data->begin(), entry->data->end(), dest.begin());
+            }
+            else if (auto result = ReadEntry(entry, dest.data(), &shared); !result) {
+                return result;
+            }
+            if (cache && m_config.lazy_load && !shared) {
+                BlobPtr blob = CacheInsert(name, dest.data(), entry->uncompressed_size, generation);
+                if (front && blob) front->Put(name, std::move(blob), epoch);
+            }
+            return PackageResult::Success();
+        }
+
+        PackageResult Extract(std::string_view name, std::string_view output_path) {
+            auto data = Get(name);
+            if (!data) return PackageResult::Failure(PackageError::FileNotFound, "File not found");
+            std::ofstream file(std::string(output_path), std::ios::binary);
+            if (!file.is_open()) return PackageResult::Failure(PackageError::IOError, "Cannot create file");
+            if (!file.write(reinterpret_cast<const char*>(data->data()), data->size())) {
+                return PackageResult::Failure(PackageError::IOError, "Write failed");
+            }
+            return PackageResult::Success();
+        }
+
+        // Entries are extracted concurrently on the job system, in file order so reads stay sequential.
+        // Decoded bytes bypass the cache and each entry holds credit until written; the first failure stops the rest.
+        PackageResult ExtractAll(std::string_view output_dir, ProgressCallback callback) {
+            std::string dir(output_dir);
+            fs::create_directories(dir);
+            DirectoryPtr directory = Snapshot();
+            std::vector<const Entry*> entries;
+            entries.reserve(directory->entries.size());
+            for (const auto& [_, entry] : directory->entries) entries.push_back(entry.get());
+            std::sort(entries.begin(), entries.end(), [](const Entry* a, const Entry* b) { return a->offset < b->offset; });
+
+            size_t current = 0;
+            std::mutex progress_mutex;
+            std::atomic<bool> failed{ false };
+            PackageResult failure = PackageResult::Success();
+            parallel::For(&Jobs(), entries.size(), [&](size_t i) {
+                if (failed.load(std::memory_order_relaxed)) return;
+                const Entry* entry = entries[i];
+                if (callback) {
+                    std::lock_guard lock(progress_mutex);
+                    callback(current++, entries.size(), entry->name);
+                }
+                auto credit = m_inflight.Acquire(BufferPool::Footprint(entry->uncompressed_size));
+                auto result = ExtractEntry(*entry, fs::path(dir) / entry->name);
+                if (!result && !failed.exchange(true)) failure = std::move(result);
+            });
+            return failure;
+        }
+
+        PackageResult ExtractEntry(const Entry& entry, const fs::path& output_path) {
+            std::error_code error;
+            fs::create_directories(output_path.parent_path(), error);
+            if (error) return PackageResult::Failure(PackageError::IOError, error.message());
+            auto staging = m_buffer_pool.Acquire(entry.uncompressed_size);
+            if (auto result = GetInto(entry.name, *staging, false); !result) return result;
+            std::ofstream file(output_path, std::ios::binary);
+            if (!file.is_open()) return PackageResult::Failure(PackageError::IOError, "Cannot create file");
+            if (!file.write(reinterpret_cast<const char*>(staging->data()), staging->size())) {
+                return PackageResult::Failure(PackageError::IOError, "Write failed");
+            }
+            return PackageResult::Success();
+        }
+
+        PackageResult VerifyAll(ProgressCallback callback) {
+            DirectoryPtr directory = Snapshot();
+            std::vector<std::shared_ptr<Entry>> stored;
+            std::vector<const Entry*> in_memory;
+            for (const auto& [_, entry] : directory->entries) {
+                if (entry->file) stored.push_back(entry);
+                else in_memory.push_back(entry.get());
+            }
+            std::sort(stored.begin(), stored.end(), [](const auto& a, const auto& b) { return a->offset < b->offset; });
+
+            size_t current = 0;
+            size_t total = directory->entries.size();
+            std::mutex progress_mutex;
+            PackageResult failure = PackageResult::Success();
+            // DecodeEntry already compares CRCs when verify_checksums is set
+            auto check = [&](const Entry* entry, PackageResult result, const uint8_t* data, size_t size) {
+                if (result && (!m_config.verify_checksums || !entry->file) &&
+                    !pak_utils::SecureCompare(pak_utils::CalculateCRC32(data, size), entry->crc32)) {
+                    result = PackageResult::Failure(PackageError::ChecksumMismatch, "CRC mismatch");
+                }
+                std::lock_guard lock(progress_mutex);
+                if (callback) callback(current++, total, entry->name);
+                if (result) return true;
+                if (failure) failure = PackageResult::Failure(result.error, result.message + ": " + std::string(entry->name));
+                return false;
+            };
+            for (const Entry* entry : in_memory) {
+                if (!check(entry, PackageResult::Success(), entry->data->data(), entry->data->size())) return failure;
+            }
+            auto result = ReadCoalesced(stored, [&](Entry* entry, const PackageResult& decoded_result, const Blob& decoded) {
+                return check(entry, decoded_result, decoded.data(), decoded.size());
+            });
+            return failure ? result : failure;
+        }
+
+        bool Remove(std::string_view name) {
+            bool removed = Modify([&](Directory& directory) {
+                auto it = directory.entries.find(name);
+                if (it == directory.entries.end()) return false;
+                directory.entries.erase(it);
+                if (auto links = directory.dependencies.find(name); links != directory.dependencies.end()) {
+                    directory.dependencies.erase(links);
+                }
+                return true;
+            });
+            if (!removed) return false;
+            Invalidate(name);
+            std::lock_guard lock(m_policy_mutex);
+            if (auto policy = m_cache_policies.find(name); policy != m_cache_policies.end()) m_cache_policies.erase(policy);
+            return true;
+        }
+
+        // Pinned entries are decoded now and kept out of eviction until unpinned. Eager packages keep every
+        // entry resident anyway, so there pinning only loads the entry.
+        PackageResult Pin(std::string_view name) {
+            uint64_t generation = m_generation.load(std::memory_order_acquire);
+            DirectoryPtr directory = Snapshot();
+            auto it = directory->entries.find(name);
+            if (it == directory->entries.end()) return PackageResult::Failure(PackageError::FileNotFound, "File not found");
+            Entry* entry = it->second.get();
+            if (!m_config.lazy_load) return LoadEntry(entry);
+            SetCachePolicy(name, [](CachePolicy& policy) { policy.pinned = true; });
+            if (m_cache.Move(name, LRUCache<BlobPtr>::PINNED)) return PackageResult::Success();
+
+            auto fail = [&](PackageResult result) {
+                SetCachePolicy(name, [](CachePolicy& policy) { policy.pinned = false; });
+                return result;
+            };
+            if (m_cache.PinnedSize() + entry->uncompressed_size > m_config.pinned_cache_size) {
+                return fail(PackageResult::Failure(PackageError::OutOfMemory, "Pinned cache budget exceeded"));
+            }
+            auto staging = m_buffer_pool.Acquire(entry->uncompressed_size);
+            if (entry->IsLoaded()) {
+                std::copy(entry->data->begin(), entry->data->end(), staging->begin());
+            }
+            else if (auto result = ReadEntry(entry, staging->data()); !result) {
+                return fail(result);
+            }
+            if (!CacheInsert(name, staging->data(), entry->uncompressed_size, generation)) {
+                return fail(PackageResult::Failure(PackageError::OutOfMemory, "Pinned cache budget exceeded"));
+            }
+            return PackageResult::Success();
+        }
+
+        bool Unpin(std::string_view name) {
+            CachePriority priority = CachePriority::Normal;
+            bool was_pinned = false;
+            SetCachePolicy(name, [&](CachePolicy& policy) {
+                was_pinned = policy.pinned;
+                policy.pinned = false;
+                priority = policy.priority;
+            });
+            if (was_pinned) m_cache.Move(name, static_cast<size_t>(priority));
+            return was_pinned;
+        }
+
+        bool SetCachePriority(std::string_view name, CachePriority priority) {
+            if (!Has(name)) return false;
+            bool pinned = false;
+            SetCachePolicy(name, [&](CachePolicy& policy) {
+                policy.priority = priority;
+                pinned = policy.pinned;
+            });
+            if (!pinned) m_cache.Move(name, static_cast<size_t>(priority));
+            return true;
+        }
+
+        size_t GetPinnedSize() const noexcept { return m_cache.PinnedSize(); }
+
+        PackageResult SaveCacheManifest(std::string_view path) const {
+            std::vector<std::string> names = m_cache.Keys();
+            std::ofstream file(std::string(path), std::ios::binary);
+            if (!file.is_open()) return PackageResult::Failure(PackageError::IOError, "Cannot create manifest");
+            IOHelper::Write(file, MANIFEST_SIGNATURE);
+            IOHelper::Write(file, MANIFEST_VERSION);
+            IOHelper::Write(file, static_cast<uint32_t>(names.size()));
+            for (const auto& name : names) {
+                if (!IOHelper::WriteString(file, name)) return PackageResult::Failure(PackageError::IOError, "Write failed");
+            }
+            return PackageResult::Success();
+        }
+
+        // Picks manifest entries in order until the budget is spent, then reads and decodes them on a
+        // background thread. Entries are read in file order, neighbours coalesced into single reads.
+        PackageResult WarmFromManifest(std::string_view path, size_t budget) {
+            std::ifstream file(std::string(path), std::ios::binary);
+            if (!file.is_open()) return PackageResult::Failure(PackageError::FileNotFound, "Cannot open manifest");
+            uint32_t sig = 0, ver = 0, count = 0;
+            if (!IOHelper::Read(file, sig) || sig != MANIFEST_SIGNATURE) {
+                return PackageResult::Failure(PackageError::InvalidSignature, "Invalid manifest signature");
+            }
+            if (!IOHelper::Read(file, ver) || ver > MANIFEST_VERSION || !IOHelper::Read(file, count)) {
+                return PackageResult::Failure(PackageError::CorruptedData, "Unsupported manifest");
+            }
+            uint64_t generation = m_generation.load(std::memory_order_acquire);
+            DirectoryPtr directory = Snapshot();
+            if (!directory->file) return PackageResult::Failure(PackageError::IOError, "Package not open");
+
+            std::lock_guard warm_lock(m_warm_mutex);
+            StopWarmupLocked();
+            if (budget == 0) budget = m_config.lazy_load ? m_cache.Capacity() : SIZE_MAX;
+            std::vector<std::shared_ptr<Entry>> selected;
+            size_t planned = 0;
+            std::string name;
+            for (uint32_t i = 0; i < count && IOHelper::ReadString(file, name); ++i) {
+                auto it = directory->entries.find(std::string_view(name));
+                if (it == directory->entries.end() || it->second->IsLoaded() || m_cache.Contains(name)) continue;
+                if (planned + it->second->uncompressed_size > budget) continue;
+                planned += it->second->uncompressed_size;
+                selected.push_back(it->second);
+            }
+            std::sort(selected.begin(), selected.end(), [](const auto& a, const auto& b) { return a->offset < b->offset; });
+            m_warm_cancel.store(false, std::memory_order_relaxed);
+            m_warm_thread = std::thread([this, selected = std::move(selected), generation] { Warm(selected, generation); });
+            return PackageResult::Success();
+        }
+
+        void WaitForWarmup() {
+            std::lock_guard lock(m_warm_mutex);
+            if (m_warm_thread.joinable()) m_warm_thread.join();
+        }
+
+        PackageResult SetDependencies(std::string_view name, const std::vector<std::string>& dependencies) {
+            return Modify([&](Directory& directory) {
+                auto it = directory.entries.find(name);
+                if (it == directory.entries.end()) return PackageResult::Failure(PackageError::FileNotFound, "File not found");
+                for (const auto& dependency : dependencies) {
+                    if (dependency == name || directory.entries.find(std::string_view(dependency)) == directory.entries.end()) {
+                        return PackageResult::Failure(PackageError::InvalidParameter, "Unknown dependency: " + dependency);
+                    }
+                }
+                if (dependencies.empty()) {
+                    if (auto links = directory.dependencies.find(name); links != directory.dependencies.end()) {
+                        directory.dependencies.erase(links);
+                    }
+                    return PackageResult::Success();
+                }
+                std::pmr::vector<std::pmr::string> keys(dependencies.begin(), dependencies.end(), m_resource);
+                directory.dependencies.insert_or_assign(std::pmr::string(name, m_resource), std::move(keys));
+                return PackageResult::Success();
+            });
+        }
+
+        std::vector<std::string> GetDependencies(std::string_view name) const {
+            DirectoryPtr directory = Snapshot();
+            auto it = directory->dependencies.find(name);
+            if (it == directory->dependencies.end()) return {};
+            return { it->second.begin(), it->second.end() };
+        }
+
+        // Cached and resident members are copied; the rest arrive through one coalesced pass over the file
+        std::optional<std::vector<std::pair<std::string, ByteArray>>> GetWithDependencies(std::string_view name) {
+            uint64_t generation = m_generation.load(std::memory_order_acquire);
+            auto closure = Closure(*Snapshot(), name);
+            if (closure.empty()) return std::nullopt;
+            std::vector<std::pair<std::string, ByteArray>> files(closure.size());
+            std::unordered_map<const Entry*, size_t> slots;
+            std::vector<std::shared_ptr<Entry>> stored;
+            for (size_t i = 0; i < closure.size(); ++i) {
+                Entry* entry = closure[i].get();
+                files[i].first = entry->name;
+                bool cached = m_cache.Read(entry->name, [&](const BlobPtr& data) { files[i].second.assign(data->begin(), data->end()); });
+                if (cached) continue;
+                if (entry->IsLoaded()) {
+                    files[i].second.assign(entry->data->begin(), entry->data->end());
+                    continue;
+                }
+                slots.emplace(entry, i);
+                stored.push_back(closure[i]);
+            }
+            std::sort(stored.begin(), stored.end(), [](const auto& a, const auto& b) { return a->offset < b->offset; });
+            auto result = ReadCoalesced(stored, [&](Entry* entry, const PackageResult& decoded_result, const Blob& decoded) {
+                if (!decoded_result) return false;
+                files[slots.at(entry)].second.assign(decoded.begin(), decoded.end());
+                Admit(entry, decoded, generation);
+                return true;
+            });
+            if (!result) return std::nullopt;
+            return files;
+        }
+
+        PackageResult PrefetchClosure(std::string_view name) {
+            uint64_t generation = m_generation.load(std::memory_order_acquire);
+            auto closure = Closure(*Snapshot(), name);
+            if (closure.empty()) return PackageResult::Failure(PackageError::FileNotFound, "File not found");
+            std::erase_if(closure, [&](const auto& entry) { return entry->IsLoaded() || m_cache.Contains(entry->name); });
+            std::sort(closure.begin(), closure.end(), [](const auto& a, const auto& b) { return a->offset < b->offset; });
+            return ReadCoalesced(closure, [&](Entry* entry, const PackageResult& result, const Blob& decoded) {
+                return result && Admit(entry, decoded, generation);
+            });
+        }
+
+        PackageResult DefineBundle(std::string_view bundle, const std::vector<std::string>& members) {
+            if (bundle.empty() || members.empty()) return PackageResult::Failure(PackageError::InvalidParameter, "Invalid parameters");
+            return Modify([&](Directory& directory) {
+                std::pmr::vector<std::pmr::string> keys(m_resource);
+                for (const auto& member : members) {
+                    if (directory.entries.find(std::string_view(member)) == directory.entries.end()) {
+                        return PackageResult::Failure(PackageError::FileNotFound, "Unknown bundle member: " + member);
+                    }
+                    keys.emplace_back(member);
+                }
+                directory.bundles.insert_or_assign(std::pmr::string(bundle, m_resource), std::move(keys));
+                return PackageResult::Success();
+            });
+        }
+
+        std::vector<std::string> ListBundles() const {
+            std::vector<std::string> names;
+            DirectoryPtr directory = Snapshot();
+            for (const auto& [name, _] : directory->bundles) names.emplace_back(name);
+            std::sort(names.begin(), names.end());
+            return names;
+        }
+
+        std::vector<std::string> GetBundle(std::string_view bundle) const {
+            DirectoryPtr directory = Snapshot();
+            auto it = directory->bundles.find(bundle);
+            if (it == directory->bundles.end()) return {};
+            return { it->second.begin(), it->second.end() };
+        }
+
+        // Saved bundles are contiguous, so this is one large sequential read (split at BUNDLE_BATCH_READ)
+        // with the members inflated in parallel
+        PackageResult LoadBundle(std::string_view bundle) {
+            uint64_t generation = m_generation.load(std::memory_order_acquire);
+            DirectoryPtr directory = Snapshot();
+            auto it = directory->bundles.find(bundle);
+            if (it == directory->bundles.end()) return PackageResult::Failure(PackageError::FileNotFound, "Bundle not found");
+            std::vector<std::shared_ptr<Entry>> members;
+            for (const auto& member : it->second) {
+                auto entry = directory->entries.find(member);
+                if (entry == directory->entries.end() || entry->second->IsLoaded() || m_cache.Contains(member)) continue;
+                members.push_back(entry->second);
+            }
+            std::sort(members.begin(), members.end(), [](const auto& a, const auto& b) { return a->offset < b->offset; });
+            return ReadCoalesced(members, [&](Entry* entry, const PackageResult& result, const Blob& decoded) {
+                return result && Admit(entry, decoded, generation);
+            }, BUNDLE_BATCH_READ);
+        }
+
+        PackageResult WarmPageCache(const std::vector<std::string>& names) {
+            return AdvisePageCache(names, FileReader::Advice::WillNeed);
+        }
+
+        PackageResult DropPageCache(const std::vector<std::string>& names) {
+            if (auto file = Snapshot()->file) file->reader->Reset();
+            return AdvisePageCache(names, FileReader::Advice::DontNeed);
+        }
+
+        PackageResult SavePrefetchModel(std::string_view path) const {
+            if (!m_predictor) return PackageResult::Failure(PackageError::InvalidParameter, "Prefetching is disabled");
+            std::ofstream file(std::string(path), std::ios::binary);
+            if (!file.is_open()) return PackageResult::Failure(PackageError::IOError, "Cannot create model");
+            IOHelper::Write(file, MODEL_SIGNATURE);
+            IOHelper::Write(file, MODEL_VERSION);
+            if (!m_predictor->Save(file)) return PackageResult::Failure(PackageError::IOError, "Write failed");
+            return PackageResult::Success();
+        }
+
+        PackageResult LoadPrefetchModel(std::string_view path) {
+            if (!m_predictor) return PackageResult::Failure(PackageError::InvalidParameter, "Prefetching is disabled");
+            std::ifstream file(std::string(path), std::ios::binary);
+            if (!file.is_open()) return PackageResult::Failure(PackageError::FileNotFound, "Cannot open model");
+            uint32_t sig = 0, ver = 0;
+            if (!IOHelper::Read(file, sig) || sig != MODEL_SIGNATURE) {
+                return PackageResult::Failure(PackageError::InvalidSignature, "Invalid model signature");
+            }
+            if (!IOHelper::Read(file, ver) || ver > MODEL_VERSION || !m_predictor->Load(file)) {
+                return PackageResult::Failure(PackageError::CorruptedData, "Corrupted model");
+            }
+            return PackageResult::Success();
+        }
+
+        PrefetchStats GetPrefetchStats() {
+            std::lock_guard lock(m_prefetch_mutex);
+            ReclaimPrefetchesLocked();
+            PrefetchStats stats = m_prefetch_stats;
+            stats.outstanding_bytes = m_prefetched_bytes;
+            return stats;
+        }
+
+        bool Has(std::string_view name) const {
+            DirectoryPtr directory = Snapshot();
+            return directory->entries.find(name) != directory->entries.end();
+        }
+
+        std::optional<FileInfo> GetFileInfo(std::string_view name) const {
+            DirectoryPtr directory = Snapshot();
+            auto it = directory->entries.find(name);
+            if (it == directory->entries.end()) return std::nullopt;
+            return MakeFileInfo(*it->second);
+        }
+
+        // Where each entry went in the new file
+        struct SavedEntry {
+            explicit SavedEntry(std::pmr::memory_resource* resource) : inline_data(resource) {}
+            uint32_t offset{ 0 };
+            uint32_t compressed_size{ 0 };
+            uint8_t flags{ 0 };
+            Blob inline_data;
+        };
+
+        // Encrypts and compresses entry into encoded, or into record.inline_data when it is small enough.
+        // Entries backed by a package file are decoded from it first.
+        PackageResult EncodeEntry(Entry& entry, SavedEntry& record, BufferPool::Lease& encoded) {
+            const uint8_t* source = entry.data ? entry.data->data() : nullptr;
+            size_t size = entry.uncompressed_size;
+            BufferPool::Lease staging;
+            bool encrypt = entry.is_encrypted && m_cipher;
+            if (entry.file || encrypt) {
+                staging = m_buffer_pool.Acquire(size);
+                if (!entry.file) std::copy(entry.data->begin(), entry.data->end(), staging->begin());
+                else if (auto result = ReadEntry(&entry, staging->data()); !result) return result;
+                if (encrypt) m_cipher->Encrypt(staging->data(), size);
+                source = staging->data();
+            }
+            encoded = m_buffer_pool.Acquire(compressBound(static_cast<uLong>(size)));
+            Blob& compressed = *encoded;
+            bool chunked = m_config.compression != CompressionLevel::None &&
+                size >= m_config.parallel_threshold && size > m_config.chunk_size;
+            auto result = chunked
+                ? CompressChunked(source, size, compressed)
+                : compression::Compress(source, size, compressed, m_config.compression);
+            if (!result) return result;
+            bool stored = !chunked && (m_config.compression == CompressionLevel::None || compressed.size() >= size);
+            if (stored) compressed.assign(source, source + size);
+            record.compressed_size = static_cast<uint32_t>(compressed.size());
+            if (entry.is_encrypted) record.flags |= static_cast<uint8_t>(EntryFlags::Encrypted);
+            if (chunked) record.flags |= static_cast<uint8_t>(EntryFlags::Chunked);
+            if (stored) record.flags |= static_cast<uint8_t>(EntryFlags::Stored);
+            if (!chunked && compressed.size() <= std::min(m_config.inline_threshold, MAX_INLINE_SIZE)) {
+                record.flags |= static_cast<uint8_t>(EntryFlags::Inline);
+                record.inline_data.assign(compressed.begin(), compressed.end());
+                encoded = {};
+            }
+            return PackageResult::Success();
+        }
+
+        // What EncodeEntry holds at its peak: the plaintext it reads or encrypts, the output, and for
+        // chunked entries the blocks gathered before they are joined
+        size_t EncodeFootprint(const Entry& entry) const {
+            size_t size = entry.uncompressed_size;
+            size_t output = BufferPool::Footprint(compressBound(static_cast<uLong>(size)));
+            bool chunked = size >= m_config.parallel_threshold && size > m_config.chunk_size;
+            return (entry.file || entry.is_encrypted ? BufferPool::Footprint(size) : 0) + (chunked ? 2 * output : output);
+        }
+
+        // One entry on its way through Save: queued for the job system, claimed by whoever runs it, then done
+        struct EncodeTask {
+            enum State : int { Queued, Claimed, Done };
+            std::atomic<int> state{ Queued };
+            size_t index{ 0 };
+            BufferPool::Lease encoded;
+            PackageResult result = PackageResult::Success();
+            ByteCredit::Grant credit;
+            std::mutex mutex;
+            std::condition_variable done;
+        };
+
+        // Works from one snapshot and leaves its entries untouched, so readers keep going meanwhile
+        PackageResult Save(std::string_view filepath, ProgressCallback callback) {
+            DirectoryPtr directory = Snapshot();
+            // Entries are read back from the loaded file while saving, so it cannot be the destination
+            std::error_code error;
+            if (directory->file && fs::equivalent(fs::path(filepath), fs::path(directory->file->path), error)) {
+                return PackageResult::Failure(PackageError::InvalidParameter, "Cannot save over the loaded package file");
+            }
+            std::ofstream file(std::string(filepath), std::ios::binary);
+            if (!file.is_open()) return PackageResult::Failure(PackageError::IOError, "Cannot create package");
+
+            IOHelper::Write(file, SIGNATURE);
+            IOHelper::Write(file, VERSION);
+            IOHelper::Write(file, static_cast<uint32_t>(directory->entries.size()));
+
+            uint32_t flags = 0;
+            if (m_config.compression != CompressionLevel::None) flags |= static_cast<uint32_t>(PackageFlags::Compressed);
+            if (m_config.encryption != EncryptionMethod::None) flags |= static_cast<uint32_t>(PackageFlags::Encrypted);
+            if (m_config.obfuscate_filenames) flags |= static_cast<uint32_t>(PackageFlags::ObfuscatedNames);
+            if (m_config.verify_checksums) flags |= static_cast<uint32_t>(PackageFlags::ChecksumVerified);
+            IOHelper::Write(file, flags);
+
+            size_t dir_offset_pos = file.tellp();
+            IOHelper::Write(file, uint32_t(0));
+
+            std::vector<Entry*> sorted = SaveOrder(*directory);
+            std::vector<SavedEntry> saved;
+            saved.reserve(sorted.size());
+            for (size_t i = 0; i < sorted.size(); ++i) saved.emplace_back(m_resource);
+
+            // Entries are encoded on the job system while this thread writes them in file order. Each holds
+            // credit from submission until written, so output queued behind a slow entry or a slow disk stays
+            // within max_inflight_bytes. Tasks nobody has started yet are run here, so the writer never waits
+            // on a busy job system, and late jobs find them claimed.
+            JobSystem& jobs = Jobs();
+            auto run = [&](EncodeTask& task) {
+                task.result = EncodeEntry(*sorted[task.index], saved[task.index], task.encoded);
+                std::lock_guard lock(task.mutex);
+                task.state.store(EncodeTask::Done, std::memory_order_release);
+                task.done.notify_all();
+            };
+            auto settle = [&](EncodeTask& task, bool cancel) {
+                int expected = EncodeTask::Queued;
+                if (task.state.compare_exchange_strong(expected, EncodeTask::Claimed)) {
+                    if (!cancel) run(task);
+                    return;
+                }
+                std::unique_lock lock(task.mutex);
+                task.done.wait(lock, [&] { return task.state.load(std::memory_order_acquire) == EncodeTask::Done; });
+            };
+            std::deque<std::shared_ptr<EncodeTask>> inflight;
+            size_t next = 0;
+            while (next < sorted.size() || !inflight.empty()) {
+                while (next < sorted.size()) {
+                    size_t footprint = EncodeFootprint(*sorted[next]);
+                    // Waiting is only safe with nothing in flight: the credit held here returns as this thread writes
+                    auto credit = inflight.empty() ? m_inflight.Acquire(footprint) : m_inflight.TryAcquire(footprint);
+                    if (!credit) break;
+                    auto task = std::make_shared<EncodeTask>();
+                    task->index = next++;
+                    task->credit = std::move(credit);
+                    inflight.push_back(task);
+                    jobs.Submit([task, &run] {
+                        int expected = EncodeTask::Queued;
+                        if (task->state.compare_exchange_strong(expected, EncodeTask::Claimed)) run(*task);
+                    });
+                }
+                std::shared_ptr<EncodeTask> task = std::move(inflight.front());
+                inflight.pop_front();
+                settle(*task, false);
+                if (callback) callback(task->index, sorted.size(), sorted[task->index]->name);
+                if (!task->result) {
+                    for (auto& pending : inflight) {
+                        settle(*pending, true);
+                        pending->credit = {};
+                    }
+                    return task->result;
+                }
+                SavedEntry& record = saved[task->index];
+                if (!(record.flags & static_cast<uint8_t>(EntryFlags::Inline))) {
+                    record.offset = static_cast<uint32_t>(file.tellp());
+                    file.write(reinterpret_cast<const char*>(task->encoded->data()), task->encoded->size());
+                }
+                // A job that finds its task already run may still hold it, so give the memory back now
+                task->encoded = {};
+                task->credit = {};
+            }
+            for (size_t i = 0; i < sorted.size(); ++i) {
+                if (!sorted[i]->file) sorted[i]->saved_size.store(saved[i].compressed_size, std::memory_order_relaxed);
+            }
+
+            uint32_t dir_offset = static_cast<uint32_t>(file.tellp());
+            for (size_t i = 0; i < sorted.size(); ++i) {
+                const Entry* entry = sorted[i];
+                const SavedEntry& record = saved[i];
+                IOHelper::WriteString(file, entry->stored_name);
+                IOHelper::Write(file, record.offset);
+                IOHelper::Write(file, record.compressed_size);
+                IOHelper::Write(file, entry->uncompressed_size);
+                IOHelper::Write(file, entry->crc32);
+                IOHelper::Write(file, record.flags);
+                file.write(reinterpret_cast<const char*>(record.inline_data.data()), record.inline_data.size());
+            }
+            if (auto result = WriteSections(file, sorted, *directory); !result) return result;
+
+            file.seekp(dir_offset_pos);
+            IOHelper::Write(file, dir_offset);
+            return PackageResult::Success();
+        }
+
+        // The new directory is published only once fully read; on failure the package is left empty
+        PackageResult Load(std::string_view filepath) {
+            Clear();
+            auto next = NewDirectory();
+            uint32_t flags = 0;
+            if (auto result = ReadDirectory(filepath, *next, flags); !result) return result;
+            m_config.encryption = (flags & static_cast<uint32_t>(PackageFlags::Encrypted)) ? EncryptionMethod::XOR : EncryptionMethod::None;
+            m_config.obfuscate_filenames = (flags & static_cast<uint32_t>(PackageFlags::ObfuscatedNames)) != 0;
+            m_config.verify_checksums = (flags & static_cast<uint32_t>(PackageFlags::ChecksumVerified)) != 0;
+            std::shared_ptr<PackageFile> file = next->file;
+            {
+                std::lock_guard lock(m_write_mutex);
+                m_directory.store(std::move(next), std::memory_order_release);
+            }
+            PrepareDiskCache(*file);
+            return PackageResult::Success();
+        }
+
+        // Swaps in a new version of the loaded package without emptying it first. Readers keep using the
+        // current file until the new one is indexed; decoded entries whose CRC and size did not change stay cached.
+        PackageResult Reload(std::string_view filepath) {
+            auto next = NewDirectory();
+            uint32_t flags = 0;
+            if (auto result = ReadDirectory(filepath, *next, flags); !result) return result;
+            // Readers use these settings without locking, so a package that needs different ones goes through Load
+            bool encrypted = (flags & static_cast<uint32_t>(PackageFlags::Encrypted)) != 0;
+            bool obfuscated = (flags & static_cast<uint32_t>(PackageFlags::ObfuscatedNames)) != 0;
+            bool verified = (flags & static_cast<uint32_t>(PackageFlags::ChecksumVerified)) != 0;
+            if (encrypted != (m_config.encryption != EncryptionMethod::None) || obfuscated != m_config.obfuscate_filenames ||
+                verified != m_config.verify_checksums) {
+                return PackageResult::Failure(PackageError::InvalidParameter, "Package flags differ from the loaded package");
+            }
+
+            std::shared_ptr<PackageFile> file = next->file;
+            std::vector<std::string> changed, repacked, removed;
+            {
+                std::lock_guard lock(m_write_mutex);
+                DirectoryPtr current = m_directory.load(std::memory_order_relaxed);
+                for (const auto& [name, entry] : current->entries) {
+                    auto it = next->entries.find(name);
+                    if (it == next->entries.end()) {
+                        removed.emplace_back(name);
+                        continue;
+                    }
+                    Entry* fresh = it->second.get();
+                    if (fresh->crc32 != entry->crc32 || fresh->uncompressed_size != entry->uncompressed_size) {
+                        changed.emplace_back(name);
+                        continue;
+                    }
+                    // Same content, maybe stored differently; the compressed tier holds stored bytes
+                    if (!SameStoredBytes(*entry, *fresh)) repacked.emplace_back(name);
+                    // Loaded data is immutable, so carrying it over needs no m_load_mutex
+                    if (!m_config.lazy_load && entry->IsLoaded()) {
+                        fresh->data = entry->data;
+                        fresh->is_loaded.store(true, std::memory_order_release);
+                    }
+                }
+                m_directory.store(std::move(next), std::memory_order_release);
+            }
+            // After publishing, as in Publish, so readers still on the old snapshot cannot cache stale bytes
+            for (const auto& name : changed) Invalidate(name);
+            for (const auto& name : removed) Invalidate(name);
+            for (const auto& name : repacked) m_compressed_cache.Erase(name);
+            if (!removed.empty()) {
+                std::lock_guard lock(m_policy_mutex);
+                for (const auto& name : removed) {
+                    if (auto it = m_cache_policies.find(std::string_view(name)); it != m_cache_policies.end()) m_cache_policies.erase(it);
+                }
+            }
+            PrepareDiskCache(*file);
+            return PackageResult::Success();
+        }
+
+        static bool SameStoredBytes(const Entry& a, const Entry& b) {
+            return a.file && b.file && a.compressed_size == b.compressed_size && a.is_encrypted == b.is_encrypted &&
+                a.is_chunked == b.is_chunked && a.is_stored == b.is_stored;
+        }
+
+        // Opens filepath and reads its directory and sections into directory, which is not yet published
+        PackageResult ReadDirectory(std::string_view filepath, Directory& directory, uint32_t& flags) {
+            std::ifstream reader(std::string(filepath), std::ios::binary);
+            auto package_file = std::make_shared<PackageFile>();
+            package_file->reader = FileReader::Open(fs::path(filepath), m_config.read_ahead_size, m_resource);
+            if (!reader.is_open() || !package_file->reader) {
+                return PackageResult::Failure(PackageError::FileNotFound, "Cannot open package");
+            }
+            package_file->path = filepath;
+            std::error_code path_error;
+            std::string source = fs::weakly_canonical(fs::path(filepath), path_error).string();
+            if (path_error) source = fs::absolute(fs::path(filepath), path_error).string();
+            package_file->source = hash::Fnv1a64(source.data(), source.size());
+
+            uint32_t sig, ver, count, dir_off;
+            if (!IOHelper::Read(reader, sig) || sig != SIGNATURE) {
+                return PackageResult::Failure(PackageError::InvalidSignature, "Invalid signature");
+            }
+            if (!IOHelper::Read(reader, ver) || ver > VERSION) {
+                return PackageResult::Failure(PackageError::InvalidSignature, "Unsupported package version");
+            }
+            if (!IOHelper::Read(reader, count) || !IOHelper::Read(reader, flags) || !IOHelper::Read(reader, dir_off)) {
+                return PackageResult::Failure(PackageError::CorruptedData, "Truncated header");
+            }
+
+            // The count is untrusted: every record takes at least a name length, four fields and its flags
+            constexpr uint64_t MIN_RECORD_SIZE = sizeof(uint16_t) + 4 * sizeof(uint32_t) + sizeof(uint8_t);
+            uint64_t file_size = package_file->reader->Size();
+            if (dir_off > file_size || count > (file_size - dir_off) / MIN_RECORD_SIZE) {
+                return PackageResult::Failure(PackageError::CorruptedData, "Directory does not fit the file");
+            }
+            uint32_t header[] = { ver, count, flags, dir_off };
+            uint64_t identity = hash::Fnv1a64(header, sizeof(header), hash::Fnv1a64(&file_size, sizeof(file_size)));
+
+            reader.seekg(dir_off);
+            directory.file = package_file;
+            std::vector<std::shared_ptr<Entry>> order;
+            for (uint32_t i = 0; i < count; ++i) {
+                auto entry = NewEntry();
+                entry->file = package_file;
+                uint8_t entry_flags;
+                if (!IOHelper::ReadString(reader, entry->stored_name) || !IOHelper::Read(reader, entry->offset) ||
+                    !IOHelper::Read(reader, entry->compressed_size) || !IOHelper::Read(reader, entry->uncompressed_size) ||
+                    !IOHelper::Read(reader, entry->crc32) || !IOHelper::Read(reader, entry_flags)) {
+                    return PackageResult::Failure(PackageError::CorruptedData, "Truncated directory");
+                }
+                entry->is_encrypted = (entry_flags & static_cast<uint8_t>(EntryFlags::Encrypted)) != 0;
+                entry->is_chunked = (entry_flags & static_cast<uint8_t>(EntryFlags::Chunked)) != 0;
+                entry->is_stored = (entry_flags & static_cast<uint8_t>(EntryFlags::Stored)) != 0;
+                entry->is_inline = (entry_flags & static_cast<uint8_t>(EntryFlags::Inline)) != 0;
+                if (!PlausibleSizes(*entry, file_size)) {
+                    return PackageResult::Failure(PackageError::CorruptedData, "Entry size does not match its stored bytes");
+                }
+                if (entry->is_inline) {
+                    if (entry->compressed_size > MAX_INLINE_SIZE) {
+                        return PackageResult::Failure(PackageError::CorruptedData, "Oversized inline entry");
+                    }
+                    entry->inline_data.resize(entry->compressed_size);
+                    if (!reader.read(reinterpret_cast<char*>(entry->inline_data.data()), entry->compressed_size)) {
+                        return PackageResult::Failure(PackageError::CorruptedData, "Truncated directory");
+                    }
+                }
+                entry->name = entry->stored_name;
+                entry->is_loaded.store(false, std::memory_order_release);
+                identity = hash::Fnv1a64(entry->stored_name.data(), entry->stored_name.size(), identity);
+                uint32_t fields[] = { entry->offset, entry->compressed_size, entry->uncompressed_size, entry->crc32 };
+                identity = hash::Fnv1a64(fields, sizeof(fields), identity);
+                order.push_back(entry);
+                directory.entries.insert_or_assign(entry->name, std::move(entry));
+            }
+            package_file->identity = identity;
+            if (ver >= SECTIONS_VERSION) {
+                if (auto result = ReadSections(reader, order, directory); !result) return result;
+            }
+            return PackageResult::Success();
+        }
+
+        // Readers allocate uncompressed_size before decoding, so it must follow from bytes the file really holds
+        static bool PlausibleSizes(const Entry& entry, uint64_t file_size) {
+            if (!entry.is_inline && uint64_t(entry.offset) + entry.compressed_size > file_size) return false;
+            if (entry.is_stored && !entry.is_chunked) return entry.uncompressed_size == entry.compressed_size;
+            if (!entry.is_chunked && entry.uncompressed_size > compression::MAX_DECOMPRESSED_SIZE) return false;
+            return entry.uncompressed_size <= entry.compressed_size * compression::MAX_INFLATE_RATIO;
+        }
+
+        // Bundle members first, each bundle contiguous in name order, then everything else by name, so
+        // walking List() reads the file front to back. An entry in several bundles is stored with the first of them.
+        static std::vector<Entry*> SaveOrder(const Directory& directory) {
+            std::vector<Entry*> order;
+            order.reserve(directory.entries.size());
+            std::unordered_set<const Entry*> placed;
+            std::vector<std::string_view> bundles;
+            for (const auto& [name, _] : directory.bundles) bundles.push_back(name);
+            std::sort(bundles.begin(), bundles.end());
+            for (auto bundle : bundles) {
+                for (const auto& member : directory.bundles.find(bundle)->second) {
+                    auto it = directory.entries.find(member);
+                    if (it != directory.entries.end() && placed.insert(it->second.get()).second) order.push_back(it->second.get());
+                }
+            }
+            size_t rest = order.size();
+            for (const auto& [_, entry] : directory.entries) {
+                if (!placed.count(entry.get())) order.push_back(entry.get());
+            }
+            std::sort(order.begin() + rest, order.end(), [](const Entry* a, const Entry* b) { return a->name < b->name; });
+            return order;
+        }
+
+        // Sections are tagged and sized so readers skip the ones they do not know
+        static PackageResult WriteSections(std::ostream& file, const std::vector<Entry*>& order, const Directory& directory) {
+            std::unordered_map<std::string_view, uint32_t> index;
+            for (uint32_t i = 0; i < order.size(); ++i) index.emplace(order[i]->name, i);
+
+            std::ostringstream dependencies;
+            uint32_t linked = 0;
+            for (uint32_t i = 0; i < order.size(); ++i) {
+                auto links = directory.dependencies.find(order[i]->name);
+                if (links == directory.dependencies.end()) continue;
+                std::vector<uint32_t> targets;
+                for (const auto& dependency : links->second) {
+                    if (auto it = index.find(dependency); it != index.end()) targets.push_back(it->second);
+                }
+                if (targets.empty()) continue;
+                ++linked;
+                IOHelper::Write(dependencies, i);
+                IOHelper::Write(dependencies, static_cast<uint32_t>(targets.size()));
+                for (uint32_t target : targets) IOHelper::Write(dependencies, target);
+            }
+
+            std::ostringstream bundles;
+            uint32_t bundle_count = 0;
+            for (const auto& [name, members] : directory.bundles) {
+                std::vector<uint32_t> targets;
+                for (const auto& member : members) {
+                    if (auto it = index.find(member); it != index.end()) targets.push_back(it->second);
+                }
+                if (targets.empty()) continue;
+                ++bundle_count;
+                IOHelper::WriteString(bundles, name);
+                IOHelper::Write(bundles, static_cast<uint32_t>(targets.size()));
+                for (uint32_t target : targets) IOHelper::Write(bundles, target);
+            }
+
+            std::vector<std::pair<uint32_t, std::string>> sections;
+            auto add_section = [&](uint32_t tag, uint32_t count, const std::ostringstream& body) {
+                if (count == 0) return;
+                std::string payload(reinterpret_cast<const char*>(&count), sizeof(count));
+                payload += body.str();
+                sections.emplace_back(tag, std::move(payload));
+            };
+            add_section(SECTION_DEPENDENCIES, linked, dependencies);
+            add_section(SECTION_BUNDLES, bundle_count, bundles);
+            IOHelper::Write(file, static_cast<uint32_t>(sections.size()));
+            for (const auto& [tag, payload] : sections) {
+                IOHelper::Write(file, tag);
+                IOHelper::Write(file, static_cast<uint32_t>(payload.size()));
+                file.write(payload.data(), payload.size());
+            }
+            if (!file) return PackageResult::Failure(PackageError::IOError, "Write failed");
+            return PackageResult::Success();
+        }
+
+        PackageResult ReadSections(std::istream& reader, const std::vector<std::shared_ptr<Entry>>& order, Directory& directory) {
+            uint32_t count = 0;
+            if (!IOHelper::Read(reader, count)) return PackageResult::Failure(PackageError::CorruptedData, "Missing sections");
+            for (uint32_t s = 0; s < count; ++s) {
+                uint32_t tag = 0, size = 0;
+                if (!IOHelper::Read(reader, tag) || !IOHelper::Read(reader, size)) {
+                    return PackageResult::Failure(PackageError::CorruptedData, "Truncated section");
+                }
+                std::streampos next = reader.tellg() + std::streamoff(size);
+                if (tag == SECTION_DEPENDENCIES && !ReadDependencies(reader, order, directory)) {
+                    return PackageResult::Failure(PackageError::CorruptedData, "Corrupted dependency section");
+                }
+                if (tag == SECTION_BUNDLES && !ReadBundles(reader, order, directory)) {
+                    return PackageResult::Failure(PackageError::CorruptedData, "Corrupted bundle section");
+                }
+                reader.seekg(next);
+            }
+            return PackageResult::Success();
+        }
+
+        bool ReadBundles(std::istream& reader, const std::vector<std::shared_ptr<Entry>>& order, Directory& directory) {
+            uint32_t count = 0;
+            if (!IOHelper::Read(reader, count)) return false;
+            for (uint32_t b = 0; b < count; ++b) {
+                std::pmr::string name(m_resource);
+                uint32_t members = 0;
+                if (!IOHelper::ReadString(reader, name) || !IOHelper::Read(reader, members) || members > order.size()) {
+                    return false;
+                }
+                std::pmr::vector<std::pmr::string> keys(m_resource);
+                keys.reserve(members);
+                for (uint32_t m = 0; m < members; ++m) {
+                    uint32_t target = 0;
+                    if (!IOHelper::Read(reader, target) || target >= order.size()) return false;
+                    keys.emplace_back(order[target]->name);
+                }
+                directory.bundles.insert_or_assign(std::move(name), std::move(keys));
+            }
+            return true;
+        }
+
+        bool ReadDependencies(std::istream& reader, const std::vector<std::shared_ptr<Entry>>& order, Directory& directory) {
+            uint32_t linked = 0;
+            if (!IOHelper::Read(reader, linked)) return false;
+            for (uint32_t l = 0; l < linked; ++l) {
+                uint32_t source = 0, targets = 0;
+                if (!IOHelper::Read(reader, source) || !IOHelper::Read(reader, targets) ||
+                    source >= order.size() || targets > order.size()) {
+                    return false;
+                }
+                auto& keys = directory.dependencies.try_emplace(order[source]->name).first->second;
+                for (uint32_t t = 0; t < targets; ++t) {
+                    uint32_t target = 0;
+                    if (!IOHelper::Read(reader, target) || target >= order.size()) return false;
+                    keys.emplace_back(order[target]->name);
+                }
+            }
+            return true;
+        }
+
+        // Readers still holding the old snapshot finish against it; the file closes when the last one lets go
+        void Clear() noexcept {
+            StopWarmup();
+            CancelPrefetches();
+            {
+                std::lock_guard lock(m_write_mutex);
+                m_directory.store(NewDirectory(), std::memory_order_release);
+            }
+            m_generation.fetch_add(1, std::memory_order_release);
+            m_cache.Clear();
+            m_compressed_cache.Clear();
+            m_front_epoch.fetch_add(1, std::memory_order_release);
+            std::lock_guard lock(m_policy_mutex);
+            m_cache_policies.clear();
+        }
+
+        std::vector<std::string> List() const {
+            std::vector<std::string> names;
+            DirectoryPtr directory = Snapshot();
+            for (const auto& [name, _] : directory->entries) names.emplace_back(name);
+            std::sort(names.begin(), names.end());
+            return names;
+        }
+
+        std::vector<FileInfo> ListDetailed() const {
+            std::vector<FileInfo> infos;
+            DirectoryPtr directory = Snapshot();
+            for (const auto& [_, entry] : directory->entries) infos.push_back(MakeFileInfo(*entry));
+            return infos;
+        }
+
+        size_t GetFileCount() const noexcept { return Snapshot()->entries.size(); }
+
+        size_t GetTotalSize() const noexcept {
+            size_t total = 0;
+            DirectoryPtr directory = Snapshot();
+            for (const auto& [_, entry] : directory->entries) total += entry->uncompressed_size;
+            return total;
+        }
+
+        size_t GetCompressedSize() const noexcept {
+            size_t total = 0;
+            DirectoryPtr directory = Snapshot();
+            for (const auto& [_, entry] : directory->entries) total += entry->StoredSize();
+            return total;
+        }
+
+        float GetCompressionRatio() const noexcept {
+            size_t total = GetTotalSize();
+            if (total == 0) return 0.0f;
+            return 1.0f - (static_cast<float>(GetCompressedSize()) / total);
+        }
+
+        void PrintStatistics() const {
+            std::cout << "\n=== RBPak Statistics ===" << std::endl;
+            std::cout << "Files: " << GetFileCount() << std::endl;
+            std::cout << "Total Size: " << pak_utils::FormatSize(GetTotalSize()) << std::endl;
+            std::cout << "Compressed: " << pak_utils::FormatSize(GetCompressedSize()) << std::endl;
+            if (GetTotalSize() > 0) {
+                std::cout << "Ratio: " << std::fixed << std::setprecision(2) << (GetCompressionRatio() * 100.0f) << "%" << std::endl;
+            }
+            std::cout << "Encrypted: " << (m_config.encryption != EncryptionMethod::None ? "Yes" : "No") << std::endl;
+            std::cout << "Obfuscated: " << (m_config.obfuscate_filenames ? "Yes" : "No") << std::endl;
+        }
+
+        const PackageConfig& GetConfig() const noexcept { return m_config; }
+        PackageError GetLastError() const noexcept { return m_last_error.load(); }
+
+        void ClearCache() noexcept {
+            m_generation.fetch_add(1, std::memory_order_release);
+            m_cache.Clear();
+            m_compressed_cache.Clear();
+            m_front_epoch.fetch_add(1, std::memory_order_release);
+            m_buffer_pool.Clear();
+        }
+        size_t GetCacheSize() const noexcept { return m_cache.Size(); }
+
+        // An arena-backed cache cannot grow past its preallocated region; inserts beyond it evict instead
+        void SetCacheCapacity(size_t bytes) {
+            std::lock_guard lock(m_pressure_mutex);
+            m_cache_capacity = bytes;
+            ApplyCapacity();
+        }
+
+        size_t GetCacheCapacity() const noexcept { return m_cache.Capacity(); }
+
+        // Moderate halves the caches; Critical drops every unpinned cached byte and idle buffer. None restores them.
+        void OnMemoryPressure(MemoryPressure level) {
+            {
+                std::lock_guard lock(m_pressure_mutex);
+                m_pressure = level;
+                ApplyCapacity();
+            }
+            if (level != MemoryPressure::None) {
+                m_buffer_pool.Clear();
+                std::lock_guard lock(m_front_mutex);
+                for (auto& front : m_front_caches) front->Clear();
+            }
+            if (m_config.memory_pressure_callback) m_config.memory_pressure_callback(level);
+        }
+
+        std::vector<MissRatioPoint> GetMissRatioCurve() const {
+            return m_miss_ratio ? m_miss_ratio->Curve() : std::vector<MissRatioPoint>{};
+        }
+
+        MemoryPressure GetMemoryPressure() const noexcept {
+            std::lock_guard lock(m_pressure_mutex);
+            return m_pressure;
+        }
+        size_t GetCompressedCacheSize() const noexcept { return m_compressed_cache.Size(); }
+        bool HasSharedCache() const noexcept { return m_shared_cache != nullptr; }
+        BufferPoolStats GetBufferPoolStats() const { return m_buffer_pool.Stats(); }
+
+    private:
+        static uint64_t NextPackageId() {
+            static std::atomic<uint64_t> next{ 1 };
+            return next.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Returns this thread's front cache for this package, creating and registering it on first use
+        FrontCache* LocalFrontCache() {
+            if (m_config.front_cache_entries == 0) return nullptr;
+            thread_local std::vector<std::pair<uint64_t, std::shared_ptr<FrontCache>>> caches;
+            for (auto& [id, cache] : caches) {
+                if (id == m_id) return cache.get();
+            }
+            std::erase_if(caches, [](auto& item) { return item.second->IsOrphaned(); });
+            auto cache = std::make_shared<FrontCache>(m_config.front_cache_entries);
+            {
+                std::lock_guard lock(m_front_mutex);
+                std::erase_if(m_front_caches, [](const auto& front) { return front.use_count() == 1; });
+                m_front_caches.push_back(cache);
+            }
+            caches.emplace_back(m_id, cache);
+            return cache.get();
+        }
+
+        DirectoryPtr Snapshot() const { return m_directory.load(std::memory_order_acquire); }
+
+        JobSystem& Jobs() const {
+            std::call_once(m_jobs_once, [&] {
+                m_jobs = m_config.job_system ? m_config.job_system
+                    : std::make_shared<WorkStealingScheduler>(parallel::ResolveThreads(m_config.worker_threads), m_config.worker_cpus);
+            });
+            return *m_jobs;
+        }
+
+        std::shared_ptr<Directory> NewDirectory() const {
+            return std::allocate_shared<Directory>(std::pmr::polymorphic_allocator<Directory>(m_resource), m_resource);
+        }
+
+        // Runs change on a copy of the current directory and publishes the copy if change reports success.
+        // Copying is linear in the entry count, so bulk writers collect their changes and publish once.
+        template<typename Change>
+        std::invoke_result_t<Change&, Directory&> Modify(Change&& change) {
+            std::lock_guard lock(m_write_mutex);
+            auto next = std::allocate_shared<Directory>(std::pmr::polymorphic_allocator<Directory>(m_resource),
+                *m_directory.load(std::memory_order_relaxed), m_resource);
+            auto result = change(*next);
+            if (result) m_directory.store(std::move(next), std::memory_order_release);
+            return result;
+        }
+
+        // Replacing an entry keeps its dependency links, which belong to the name
+        void Publish(std::vector<std::shared_ptr<Entry>> entries) {
+            if (entries.empty()) return;
+            Modify([&](Directory& directory) {
+                for (const auto& entry : entries) directory.entries.insert_or_assign(entry->name, entry);
+                return true;
+            });
+            // After publishing, so a reader that raced the swap sees the generation move and drops what it cached
+            for (const auto& entry : entries) Invalidate(entry->name);
+        }
+
+        PackageResult MakeEntry(std::string_view name, const uint8_t* data, size_t size, std::shared_ptr<Entry>& entry) {
+            if (name.empty() || !data || size == 0) {
+                return PackageResult::Failure(PackageError::InvalidParameter, "Invalid parameters");
+            }
+            entry = NewEntry();
+            entry->name = name;
+            if (m_config.obfuscate_filenames) entry->stored_name = hash::Obfuscate(name);
+            else entry->stored_name = name;
+            entry->data = MakeBlob(m_resource, data, size);
+            entry->uncompressed_size = static_cast<uint32_t>(size);
+            entry->crc32 = pak_utils::CalculateCRC32(data, size);
+            entry->is_encrypted = (m_config.encryption != EncryptionMethod::None);
+            entry->is_loaded.store(true, std::memory_order_release);
+            return PackageResult::Success();
+        }
+
+        PackageResult MakeEntryFromFile(std::string_view name, std::string_view filepath, std::shared_ptr<Entry>& entry) {
+            std::ifstream file(std::string(filepath), std::ios::binary);
+            if (!file.is_open()) {
+                return PackageResult::Failure(PackageError::FileNotFound, "Cannot open file");
+            }
+            file.seekg(0, std::ios::end);
+            size_t size = file.tellg();
+            file.seekg(0, std::ios::beg);
+            auto data = m_buffer_pool.Acquire(size);
+            if (!file.read(reinterpret_cast<char*>(data->data()), size)) {
+                return PackageResult::Failure(PackageError::IOError, "Cannot read file");
+            }
+            return MakeEntry(name, data->data(), data->size(), entry);
+        }
+
+        // The generation moves before the erase so in-flight inserts are caught by Stale, and the front epoch
+        // after it so a front cache filled from the old blob in between no longer matches
+        void Invalidate(std::string_view name) {
+            m_generation.fetch_add(1, std::memory_order_release);
+            m_cache.Erase(name);
+            m_compressed_cache.Erase(name);
+            m_front_epoch.fetch_add(1, std::memory_order_release);
+        }
+
+        BlobPtr CacheInsert(std::string_view name, const uint8_t* data, size_t size) {
+            std::pmr::memory_resource* resource = m_cache_arena ? m_cache_arena.get() : m_resource;
+            return m_cache.Put(name, size, [&] { return MakeBlob(resource, data, size); }, CacheClass(name));
+        }
+
+        // For bytes decoded from a snapshot taken at generation; nullptr when rejected or already stale
+        BlobPtr CacheInsert(std::string_view name, const uint8_t* data, size_t size, uint64_t generation) {
+            BlobPtr blob = CacheInsert(name, data, size);
+            return Stale(name, generation) ? nullptr : blob;
+        }
+
+        // Undoes a cache insert made from data older than generation. Invalidate bumps the generation
+        // before erasing, so an insert that raced a writer is always caught here. Readers may have copied
+        // the blob into their front caches before it was erased, so those are retired too.
+        bool Stale(std::string_view name, uint64_t generation) {
+            if (m_generation.load(std::memory_order_acquire) == generation) return false;
+            m_cache.Erase(name);
+            m_front_epoch.fetch_add(1, std::memory_order_release);
+            return true;
+        }
+
+        // Only sampled names pay for the directory lookup and the curve's lock
+        void TrackAccess(std::string_view name) {
+            uint32_t key = hash::MurmurHash3(name.data(), name.size());
+            if (!m_miss_ratio->Sampled(key)) return;
+            DirectoryPtr directory = Snapshot();
+            auto it = directory->entries.find(name);
+            if (it == directory->entries.end()) return;
+            if (m_miss_ratio->Record(key, it->second->uncompressed_size) && m_config.target_hit_ratio > 0.0) {
+                RetuneCapacity();
+            }
+        }
+
+        void RetuneCapacity() {
+            if (m_miss_ratio->Accesses() < MISS_RATIO_MIN_ACCESSES) return;
+            size_t high = m_config.max_auto_cache_size ? m_config.max_auto_cache_size : m_config.max_cache_size;
+            size_t low = std::min(m_config.min_auto_cache_size, high);
+            size_t capacity = m_miss_ratio->CapacityFor(m_config.target_hit_ratio, low, high);
+            std::lock_guard lock(m_pressure_mutex);
+            // Ignore small moves so sampling noise does not keep resizing the cache
+            size_t current = m_cache_capacity;
+            if (capacity > current + current / 8 || capacity + current / 8 < current) {
+                m_cache_capacity = capacity;
+                ApplyCapacity();
+            }
+        }
+
+        // Credits a demanded prefetch, then queues the predicted successors of name
+        void Predict(std::string_view name) {
+            auto predictions = m_predictor->Record(name, m_config.prefetch_depth, m_config.prefetch_min_confidence);
+            uint64_t generation = m_generation.load(std::memory_order_acquire);
+            DirectoryPtr directory = Snapshot();
+            std::unique_lock lock(m_prefetch_mutex);
+            if (auto it = m_prefetched.find(name); it != m_prefetched.end()) {
+                ++m_prefetch_stats.hits;
+                m_prefetched_bytes -= it->second;
+                m_prefetched.erase(it);
+            }
+            for (const auto& next : predictions) {
+                auto it = directory->entries.find(std::string_view(next));
+                if (it == directory->entries.end() || it->second->IsLoaded() || m_prefetched.count(next) || m_cache.Contains(next)) continue;
+                bool pending = std::any_of(m_prefetch_queue.begin(), m_prefetch_queue.end(),
+                    [&](const auto& queued) { return std::string_view(queued.first->name) == next; });
+                if (pending) continue;
+                if (m_prefetch_queue.size() >= PREFETCH_QUEUE_LIMIT) {
+                    ++m_prefetch_stats.dropped;
+                    continue;
+                }
+                m_prefetch_queue.emplace_back(it->second, generation);
+            }
+            // Throttled work waits for the timer, or the first access after its tokens are due
+            if (m_prefetch_queue.empty() || m_prefetch_draining || m_prefetch_stop) return;
+            if (std::chrono::steady_clock::now() < m_prefetch_due) return;
+            m_prefetch_draining = true;
+            lock.unlock();
+            Jobs().Submit([this] { DrainPrefetches(); });
+        }
+
+        // Prefetches that left the cache before anyone asked for them were wasted
+        void ReclaimPrefetchesLocked() {
+            for (auto it = m_prefetched.begin(); it != m_prefetched.end();) {
+                if (m_cache.Contains(it->first)) {
+                    ++it;
+                    continue;
+                }
+                ++m_prefetch_stats.wasted;
+                m_prefetched_bytes -= it->second;
+                it = m_prefetched.erase(it);
+            }
+        }
+
+        // One job at a time empties the queue, or stops at an entry it cannot afford yet and leaves the rest to the timer
+        void DrainPrefetches() {
+            using Clock = std::chrono::steady_clock;
+            const double rate = static_cast<double>(m_config.prefetch_bytes_per_second);
+            std::unique_lock lock(m_prefetch_mutex);
+            auto finish = [&] {
+                m_prefetch_draining = false;
+                m_prefetch_cv.notify_all();
+            };
+            for (;;) {
+                if (m_prefetch_stop || m_prefetch_queue.empty()) return finish();
+                auto [entry, generation] = std::move(m_prefetch_queue.front());
+                m_prefetch_queue.pop_front();
+                ReclaimPrefetchesLocked();
+                if (m_prefetched_bytes + entry->uncompressed_size > m_config.prefetch_memory_budget) {
+                    ++m_prefetch_stats.dropped;
+                    continue;
+                }
+                // Token bucket holding at most one second of bandwidth; an entry larger than that goes once the
+                // bucket is full and empties it. Waiting for tokens here would hold a worker, or the
+                // caller of Get under an inline job system, so the drain ends and the timer resubmits it.
+                if (rate > 0.0) {
+                    double& tokens = m_prefetch_tokens;
+                    auto now = Clock::now();
+                    tokens = std::min(rate, tokens + rate * std::chrono::duration<double>(now - m_prefetch_refilled).count());
+                    m_prefetch_refilled = now;
+                    double needed = std::min<double>(entry->uncompressed_size, rate);
+                    if (tokens < needed) {
+                        auto wait = std::chrono::duration<double>((needed - tokens) / rate);
+                        m_prefetch_due = now + std::chrono::duration_cast<Clock::duration>(wait);
+                        m_prefetch_queue.emplace_front(std::move(entry), generation);
+                        m_prefetch_throttled = true;
+                        if (!m_prefetch_timer.joinable()) m_prefetch_timer = std::thread([this] { ResumePrefetches(); });
+                        return finish();
                     }
+                    tokens -= needed;
                 }
-                size_t current = 0;
-                for (const auto& file : files) {
-                    std::string relative = fs::relative(file, dir_str).string();
-                    if (callback) callback(current++, files.size(), relative);
-                    if (auto result = AddFromFile(relative, file.string()); !result) {
-                        std::cerr << "Failed to add: " << relative << std::endl;
+                m_prefetch_busy = true;
+                lock.unlock();
+
+                bool inserted = false;
+                if (!m_cache.Contains(entry->name)) {
+                    auto staging = m_buffer_pool.Acquire(entry->uncompressed_size);
+                    bool shared = false;
+                    if (ReadEntry(entry.get(), staging->data(), &shared) && !shared) {
+                        inserted = CacheInsert(entry->name, staging->data(), staging->size(), generation) != nullptr;
                     }
                 }
-                return PackageResult::Success();
+
+                lock.lock();
+                m_prefetch_busy = false;
+                if (inserted) {
+                    ++m_prefetch_stats.issued;
+                    m_prefetched.try_emplace(std::string(entry->name), entry->uncompressed_size);
+                    m_prefetched_bytes += entry->uncompressed_size;
+                }
+                m_prefetch_cv.notify_all();
             }
-            catch (const std::exception& e) {
-                return PackageResult::Failure(PackageError::IOError, e.what());
+        }
+
+        // Runs on its own thread rather than a worker: sleeps until a throttled queue can be afforded, then submits
+        // the next drain, so queued prefetches go ahead even when no further accesses come
+        void ResumePrefetches() {
+            std::unique_lock lock(m_prefetch_mutex);
+            for (;;) {
+                m_prefetch_cv.wait(lock, [&] { return m_prefetch_stop || m_prefetch_throttled; });
+                if (m_prefetch_cv.wait_until(lock, m_prefetch_due, [&] { return m_prefetch_stop; })) return;
+                m_prefetch_throttled = false;
+                if (m_prefetch_queue.empty() || m_prefetch_draining) continue;
+                m_prefetch_draining = true;
+                lock.unlock();
+                Jobs().Submit([this] { DrainPrefetches(); });
+                lock.lock();
             }
         }
 
-        PackageResult AddMultiple(const std::vector<std::pair<std::string, ByteArray>>& files, ProgressCallback callback) {
-            size_t current = 0;
-            for (const auto& [name, data] : files) {
-                if (callback) callback(current++, files.size(), name);
-                if (auto result = Add(name, data.data(), data.size()); !result) {
-                    return result;
+        // Drops queued work and waits out an in-flight read, so Clear can release the file and entries
+        void CancelPrefetches() {
+            if (!m_predictor) return;
+            std::unique_lock lock(m_prefetch_mutex);
+            m_prefetch_queue.clear();
+            m_prefetch_cv.wait(lock, [&] { return !m_prefetch_busy; });
+            m_prefetched.clear();
+            m_prefetched_bytes = 0;
+        }
+
+        void StopWarmup() {
+            std::lock_guard lock(m_warm_mutex);
+            StopWarmupLocked();
+        }
+
+        void StopWarmupLocked() {
+            m_warm_cancel.store(true, std::memory_order_relaxed);
+            if (m_warm_thread.joinable()) m_warm_thread.join();
+        }
+
+        // Entries the shared segment or the disk cache hold decoded are taken from there; only the rest
+        // are read from the package file
+        void Warm(const std::vector<std::shared_ptr<Entry>>& entries, uint64_t generation) {
+            std::vector<std::shared_ptr<Entry>> stored;
+            stored.reserve(entries.size());
+            for (const auto& entry : entries) {
+                if (m_warm_cancel.load(std::memory_order_relaxed)) return;
+                if (SharedCacheKey(entry.get()) == 0 && !UsesDiskCache(entry.get())) {
+                    stored.push_back(entry);
+                    continue;
+                }
+                auto decoded = m_buffer_pool.Acquire(entry->uncompressed_size);
+                bool shared = false;
+                if (!ReadDecodedTiers(entry.get(), decoded->data(), &shared)) {
+                    stored.push_back(entry);
+                    continue;
                 }
+                if ((!shared || !m_config.lazy_load) && !Admit(entry.get(), *decoded, generation)) return;
             }
-            return PackageResult::Success();
+            ReadCoalesced(stored, [&](Entry* entry, const PackageResult& result, const Blob& decoded) {
+                if (m_warm_cancel.load(std::memory_order_relaxed)) return false;
+                return !result || Admit(entry, decoded, generation);
+            });
         }
 
-        std::optional<ByteArray> Get(std::string_view name) {
-            std::string key(name);
-            if (auto cached = m_cache.Get(key)) return cached;
-            auto it = m_entries.find(key);
-            if (it == m_entries.end()) return std::nullopt;
-            Entry* entry = it->second.get();
-            if (!entry->is_loaded) {
-                if (auto result = LoadEntry(entry); !result) return std::nullopt;
+        // Reads stored entries, sorted by offset, in as few reads as possible: neighbours closer than
+        // COALESCE_GAP share one read of up to max_batch bytes. Each decoded entry (or its decode failure)
+        // goes to visit, which returns false to stop. Batches worth at least chunk_size of output are
+        // decoded in parallel, so visit must be safe to call concurrently.
+        template<typename Visit>
+        PackageResult ReadCoalesced(const std::vector<std::shared_ptr<Entry>>& requested, Visit&& visit,
+            uint64_t max_batch = MAX_BATCH_READ) {
+            // Inline entries are already in memory
+            std::vector<std::shared_ptr<Entry>> on_disk;
+            on_disk.reserve(requested.size());
+            for (const auto& entry : requested) {
+                if (!entry->is_inline) {
+                    on_disk.push_back(entry);
+                    continue;
+                }
+                auto decoded = m_buffer_pool.Acquire(entry->uncompressed_size);
+                auto result = DecodeEntry(entry.get(), entry->inline_data.data(), entry->inline_data.size(), decoded->data());
+                if (!visit(entry.get(), result, *decoded)) return result;
+            }
+            const auto& entries = on_disk;
+            for (size_t first = 0; first < entries.size();) {
+                const auto& file = entries[first]->file;
+                if (!file) return PackageResult::Failure(PackageError::IOError, "Package not open");
+                size_t last = first;
+                uint64_t start = entries[first]->offset;
+                uint64_t end = start + entries[first]->compressed_size;
+                size_t output = entries[first]->uncompressed_size;
+                while (last + 1 < entries.size()) {
+                    const Entry& next = *entries[last + 1];
+                    if (next.file != file || next.offset > end + COALESCE_GAP || next.offset + next.compressed_size - start > max_batch) break;
+                    end = std::max<uint64_t>(end, next.offset + next.compressed_size);
+                    output += next.uncompressed_size;
+                    ++last;
+                }
+                auto batch = m_buffer_pool.Acquire(static_cast<size_t>(end - start));
+                if (!file->reader->ReadAt(start, batch->data(), batch->size())) {
+                    return PackageResult::Failure(PackageError::IOError, "Read failed");
+                }
+
+                std::atomic<bool> stopped{ false };
+                PackageResult failure = PackageResult::Success();
+                std::mutex failure_mutex;
+                auto decode = [&](size_t i) {
+                    if (stopped.load(std::memory_order_relaxed)) return;
+                    Entry* entry = entries[i].get();
+                    auto decoded = m_buffer_pool.Acquire(entry->uncompressed_size);
+                    auto result = DecodeEntry(entry, batch->data() + (entry->offset - start), entry->compressed_size, decoded->data());
+                    if (!visit(entry, result, *decoded)) {
+                        std::lock_guard lock(failure_mutex);
+                        if (!stopped.exchange(true)) failure = std::move(result);
+                    }
+                };
+                size_t members = last - first + 1;
+                JobSystem* jobs = members > 1 && output >= m_config.chunk_size ? &Jobs() : nullptr;
+                parallel::For(jobs, members, [&](size_t k) { decode(first + k); });
+                if (stopped.load()) return failure;
+                first = last + 1;
             }
+            return PackageResult::Success();
+        }
+
+        // Keeps a decoded entry the way Get would: in the cache when lazy, in the entry otherwise.
+        // Returns false when the package changed since generation, leaving nothing stale behind.
+        bool Admit(Entry* entry, const Blob& decoded, uint64_t generation) {
             if (m_config.lazy_load) {
-                m_cache.Put(key, entry->data, entry->data.size());
+                CacheInsert(entry->name, decoded.data(), decoded.size());
+                return !Stale(entry->name, generation);
             }
-            return entry->data;
+            if (entry->IsLoaded()) return true;
+            std::lock_guard lock(m_load_mutex);
+            if (!entry->IsLoaded()) {
+                entry->data = MakeBlob(m_resource, decoded.data(), decoded.size());
+                entry->is_loaded.store(true, std::memory_order_release);
+            }
+            return true;
         }
 
-        PackageResult Extract(std::string_view name, std::string_view output_path) {
-            auto data = Get(name);
-            if (!data) return PackageResult::Failure(PackageError::FileNotFound, "File not found");
-            std::ofstream file(std::string(output_path), std::ios::binary);
-            if (!file.is_open()) return PackageResult::Failure(PackageError::IOError, "Cannot create file");
-            if (!file.write(reinterpret_cast<const char*>(data->data()), data->size())) {
-                return PackageResult::Failure(PackageError::IOError, "Write failed");
+        // name first, then everything it reaches through dependency links, each once
+        static std::vector<std::shared_ptr<Entry>> Closure(const Directory& directory, std::string_view name) {
+            std::vector<std::shared_ptr<Entry>> closure;
+            auto root = directory.entries.find(name);
+            if (root == directory.entries.end()) return closure;
+            std::unordered_set<const Entry*> seen{ root->second.get() };
+            closure.push_back(root->second);
+            for (size_t i = 0; i < closure.size(); ++i) {
+                auto links = directory.dependencies.find(closure[i]->name);
+                if (links == directory.dependencies.end()) continue;
+                for (const auto& dependency : links->second) {
+                    auto it = directory.entries.find(dependency);
+                    if (it != directory.entries.end() && seen.insert(it->second.get()).second) closure.push_back(it->second);
+                }
             }
-            return PackageResult::Success();
+            return closure;
         }
 
-        PackageResult ExtractAll(std::string_view output_dir, ProgressCallback callback) {
-            std::string dir(output_dir);
-            fs::create_directories(dir);
-            size_t current = 0;
-            size_t total = m_entries.size();
-            for (const auto& [name, entry] : m_entries) {
-                if (callback) callback(current++, total, name);
-                fs::path output_path = fs::path(dir) / name;
-                fs::create_directories(output_path.parent_path());
-                if (auto result = Extract(name, output_path.string()); !result) {
-                    return result;
+        // Applies advice to the stored bytes of the named entries (the whole file when none are named),
+        // neighbours closer than COALESCE_GAP merged into one range
+        PackageResult AdvisePageCache(const std::vector<std::string>& names, FileReader::Advice advice) {
+            DirectoryPtr directory = Snapshot();
+            if (!directory->file) return PackageResult::Failure(PackageError::IOError, "Package not open");
+            FileReader& reader = *directory->file->reader;
+            std::vector<std::pair<uint64_t, uint64_t>> spans;
+            if (names.empty()) spans.emplace_back(0, reader.Size());
+            for (const auto& name : names) {
+                auto it = directory->entries.find(std::string_view(name));
+                if (it == directory->entries.end()) return PackageResult::Failure(PackageError::FileNotFound, "Entry not found");
+                const auto& entry = it->second;
+                if (entry->file != directory->file || entry->is_inline) continue;
+                spans.emplace_back(entry->offset, entry->offset + entry->compressed_size);
+            }
+            std::sort(spans.begin(), spans.end());
+            size_t merged = 0;
+            for (const auto& span : spans) {
+                if (merged > 0 && span.first <= spans[merged - 1].second + COALESCE_GAP) {
+                    spans[merged - 1].second = std::max(spans[merged - 1].second, span.second);
+                }
+                else {
+                    spans[merged++] = span;
+                }
+            }
+            spans.resize(merged);
+
+            for (const auto& [start, end] : spans) {
+                if (end <= start || reader.Advise(advice, start, end - start)) continue;
+                if (advice == FileReader::Advice::DontNeed) {
+                    return PackageResult::Failure(PackageError::IOError, "Page cache control unavailable");
+                }
+                // Without hints, reading the range is what brings it into the page cache
+                auto scratch = m_buffer_pool.Acquire(static_cast<size_t>(std::min(end - start, MAX_BATCH_READ)));
+                for (uint64_t at = start; at < end; at += scratch->size()) {
+                    size_t size = static_cast<size_t>(std::min<uint64_t>(end - at, scratch->size()));
+                    if (!reader.ReadAt(at, scratch->data(), size)) return PackageResult::Failure(PackageError::IOError, "Read failed");
                 }
             }
             return PackageResult::Success();
         }
 
-        bool Remove(std::string_view name) {
-            return m_entries.erase(std::string(name)) > 0;
+        void ApplyCapacity() {
+            auto scale = [&](size_t bytes) {
+                switch (m_pressure) {
+                case MemoryPressure::Moderate: return bytes / 2;
+                case MemoryPressure::Critical: return size_t(0);
+                default: return bytes;
+                }
+            };
+            m_cache.SetCapacity(scale(m_cache_capacity));
+            m_compressed_cache.SetCapacity(scale(m_config.compressed_cache_size));
         }
 
-        bool Has(std::string_view name) const {
-            return m_entries.find(std::string(name)) != m_entries.end();
+        // Policies outlive cache residency, so an invalidated pinned entry is pinned again when next cached
+        size_t CacheClass(std::string_view name) const {
+            std::lock_guard lock(m_policy_mutex);
+            auto it = m_cache_policies.find(name);
+            if (it == m_cache_policies.end()) return static_cast<size_t>(CachePriority::Normal);
+            return it->second.pinned ? LRUCache<BlobPtr>::PINNED : static_cast<size_t>(it->second.priority);
         }
 
-        std::optional<FileInfo> GetFileInfo(std::string_view name) const {
-            auto it = m_entries.find(std::string(name));
-            if (it == m_entries.end()) return std::nullopt;
-            const Entry* entry = it->second.get();
-            return FileInfo{ entry->name, entry->stored_name, entry->uncompressed_size,
-                          entry->compressed_size, entry->crc32, entry->is_encrypted, entry->is_loaded };
+        template<typename Update>
+        void SetCachePolicy(std::string_view name, Update&& update) {
+            std::lock_guard lock(m_policy_mutex);
+            auto it = m_cache_policies.find(name);
+            if (it == m_cache_policies.end()) it = m_cache_policies.emplace(std::pmr::string(name, m_resource), CachePolicy{}).first;
+            update(it->second);
+            if (!it->second.pinned && it->second.priority == CachePriority::Normal) m_cache_policies.erase(it);
         }
 
-        PackageResult Save(std::string_view filepath, ProgressCallback callback) {
-            std::ofstream file(std::string(filepath), std::ios::binary);
-            if (!file.is_open()) return PackageResult::Failure(PackageError::IOError, "Cannot create package");
-
-            IOHelper::Write(file, SIGNATURE);
-            IOHelper::Write(file, VERSION);
-            IOHelper::Write(file, static_cast<uint32_t>(m_entries.size()));
+        std::shared_ptr<Entry> NewEntry() {
+            return std::allocate_shared<Entry>(std::pmr::polymorphic_allocator<Entry>(m_resource), m_resource);
+        }
 
-            uint32_t flags = 0;
-            if (m_config.compression != CompressionLevel::None) flags |= static_cast<uint32_t>(PackageFlags::Compressed);
-            if (m_config.encryption != EncryptionMethod::None) flags |= static_cast<uint32_t>(PackageFlags::Encrypted);
-            if (m_config.obfuscate_filenames) flags |= static_cast<uint32_t>(PackageFlags::ObfuscatedNames);
-            if (m_config.verify_checksums) flags |= static_cast<uint32_t>(PackageFlags::ChecksumVerified);
-            IOHelper::Write(file, flags);
+        static FileInfo MakeFileInfo(const Entry& entry) {
+            return FileInfo{ std::string(entry.name), std::string(entry.stored_name), entry.uncompressed_size,
+                          entry.StoredSize(), entry.crc32, entry.is_encrypted, entry.IsLoaded() };
+        }
 
-            size_t dir_offset_pos = file.tellp();
-            IOHelper::Write(file, uint32_t(0));
+        // Decodes an eager entry once. Its data never changes afterwards, so callers that see IsLoaded copy
+        // it without the lock; only first decodes take m_load_mutex.
+        PackageResult LoadEntry(Entry* entry) {
+            if (entry->IsLoaded()) return PackageResult::Success();
+            std::lock_guard lock(m_load_mutex);
+            if (entry->IsLoaded()) return PackageResult::Success();
+            Blob decompressed(entry->uncompressed_size, m_resource);
+            if (auto result = ReadEntry(entry, decompressed.data()); !result) {
+                return result;
+            }
+            entry->data = std::allocate_shared<Blob>(std::pmr::polymorphic_allocator<Blob>(m_resource), std::move(decompressed));
+            entry->is_loaded.store(true, std::memory_order_release);
+            return PackageResult::Success();
+        }
 
-            std::vector<Entry*> sorted;
-            for (auto& [_, entry] : m_entries) sorted.push_back(entry.get());
+        // Reads, inflates, decrypts and verifies an entry into dst, which must hold uncompressed_size bytes.
+        // With a compressed tier, the stored bytes are served from or kept in memory instead of staged.
+        // shared is set when the host-wide segment holds the entry, so callers need not keep a private copy.
+        PackageResult ReadEntry(Entry* entry, uint8_t* dst, bool* shared = nullptr) {
+            if (ReadDecodedTiers(entry, dst, shared)) return PackageResult::Success();
+            auto result = ReadAndDecode(entry, dst);
+            if (result && UsesDiskCache(entry)) WriteDiskCache(entry, dst);
+            if (result) WriteSharedCache(entry, dst, shared);
+            return result;
+        }
 
-            size_t current = 0;
-            for (auto* entry : sorted) {
-                if (callback) callback(current++, sorted.size(), entry->name);
-                ByteArray processed = entry->data;
-                if (entry->is_encrypted && m_cipher) {
-                    m_cipher->Encrypt(processed.data(), processed.size());
-                }
-                ByteArray compressed;
-                if (auto result = compression::Compress(processed.data(), processed.size(), compressed, m_config.compression); !result) {
-                    return result;
-                }
-                entry->offset = static_cast<uint32_t>(file.tellp());
-                entry->compressed_size = static_cast<uint32_t>(compressed.size());
-                file.write(reinterpret_cast<const char*>(compressed.data()), compressed.size());
+        // The tiers holding decoded copies, in front of the package file: the shared segment, then the disk
+        // cache. What the disk cache serves is offered to the segment.
+        bool ReadDecodedTiers(Entry* entry, uint8_t* dst, bool* shared) {
+            uint64_t shared_key = SharedCacheKey(entry);
+            if (shared_key != 0 && m_shared_cache->Read(shared_key, dst, entry->uncompressed_size, entry->crc32) &&
+                (!m_config.verify_checksums || pak_utils::CalculateCRC32(dst, entry->uncompressed_size) == entry->crc32)) {
+                if (shared) *shared = true;
+                return true;
             }
+            if (!UsesDiskCache(entry) || !ReadDiskCache(entry, dst)) return false;
+            WriteSharedCache(entry, dst, shared);
+            return true;
+        }
 
-            uint32_t dir_offset = static_cast<uint32_t>(file.tellp());
-            for (auto* entry : sorted) {
-                IOHelper::WriteString(file, entry->stored_name);
-                IOHelper::Write(file, entry->offset);
-                IOHelper::Write(file, entry->compressed_size);
-                IOHelper::Write(file, entry->uncompressed_size);
-                IOHelper::Write(file, entry->crc32);
-                IOHelper::Write(file, static_cast<uint8_t>(entry->is_encrypted ? 1 : 0));
+        void WriteSharedCache(const Entry* entry, const uint8_t* data, bool* shared) {
+            uint64_t shared_key = SharedCacheKey(entry);
+            if (shared_key != 0 && m_shared_cache->Write(shared_key, data, entry->uncompressed_size, entry->crc32) && shared) {
+                *shared = true;
             }
+        }
 
-            file.seekp(dir_offset_pos);
-            IOHelper::Write(file, dir_offset);
-            return PackageResult::Success();
+        // 0 when the entry must not go to the shared segment (no segment, in-memory entry, encrypted, inline)
+        uint64_t SharedCacheKey(const Entry* entry) const {
+            if (!m_shared_cache || !entry->file || entry->is_encrypted || entry->is_inline) return 0;
+            uint64_t key = hash::Fnv1a64(entry->name.data(), entry->name.size(), entry->file->identity);
+            uint32_t fields[] = { entry->crc32, entry->uncompressed_size };
+            key = hash::Fnv1a64(fields, sizeof(fields), key);
+            return key ? key : 1;
         }
 
-        PackageResult Load(std::string_view filepath) {
-            Clear();
-            if (m_reader.is_open()) m_reader.close();
-            m_reader.open(std::string(filepath), std::ios::binary);
-            if (!m_reader.is_open()) {
-                return PackageResult::Failure(PackageError::FileNotFound, "Cannot open package");
+        PackageResult ReadAndDecode(const Entry* entry, uint8_t* dst) {
+            if (entry->is_inline) return DecodeEntry(entry, entry->inline_data.data(), entry->inline_data.size(), dst);
+            if (m_config.compressed_cache_size == 0) {
+                auto compressed = m_buffer_pool.Acquire(entry->compressed_size);
+                if (auto result = ReadStored(entry, compressed->data()); !result) return result;
+                return DecodeEntry(entry, compressed->data(), compressed->size(), dst);
             }
-            m_filepath = filepath;
-
-            uint32_t sig, ver, count, flags, dir_off;
-            if (!IOHelper::Read(m_reader, sig) || sig != SIGNATURE) {
-                return PackageResult::Failure(PackageError::InvalidSignature, "Invalid signature");
+            BlobPtr stored;
+            if (auto cached = m_compressed_cache.Get(entry->name)) {
+                stored = std::move(*cached);
+            }
+            else {
+                auto blob = std::allocate_shared<Blob>(std::pmr::polymorphic_allocator<Blob>(m_resource), entry->compressed_size);
+                if (auto result = ReadStored(entry, blob->data()); !result) return result;
+                stored = blob;
+                m_compressed_cache.Put(entry->name, stored->size(), [&] { return stored; });
+                // Writers erase after publishing, so bytes of an entry replaced meanwhile are caught here
+                if (!IsCurrent(entry)) m_compressed_cache.Erase(entry->name);
             }
-            IOHelper::Read(m_reader, ver);
-            IOHelper::Read(m_reader, count);
-            IOHelper::Read(m_reader, flags);
-            IOHelper::Read(m_reader, dir_off);
+            return DecodeEntry(entry, stored->data(), stored->size(), dst);
+        }
 
-            m_config.encryption = (flags & static_cast<uint32_t>(PackageFlags::Encrypted)) ? EncryptionMethod::XOR : EncryptionMethod::None;
-            m_config.obfuscate_filenames = (flags & static_cast<uint32_t>(PackageFlags::ObfuscatedNames)) != 0;
-            m_config.verify_checksums = (flags & static_cast<uint32_t>(PackageFlags::ChecksumVerified)) != 0;
+        bool IsCurrent(const Entry* entry) const {
+            DirectoryPtr directory = Snapshot();
+            auto it = directory->entries.find(entry->name);
+            return it != directory->entries.end() && it->second.get() == entry;
+        }
 
-            m_reader.seekg(dir_off);
-            for (uint32_t i = 0; i < count; ++i) {
-                auto entry = std::make_unique<Entry>();
-                IOHelper::ReadString(m_reader, entry->stored_name);
-                IOHelper::Read(m_reader, entry->offset);
-                IOHelper::Read(m_reader, entry->compressed_size);
-                IOHelper::Read(m_reader, entry->uncompressed_size);
-                IOHelper::Read(m_reader, entry->crc32);
-                uint8_t enc;
-                IOHelper::Read(m_reader, enc);
-                entry->is_encrypted = (enc != 0);
-                entry->name = entry->stored_name;
-                entry->is_loaded = false;
-                m_entries[entry->name] = std::move(entry);
-            }
-            return PackageResult::Success();
+        // The disk cache keeps plaintext copies, so encrypted entries never go there; inline entries are
+        // already in memory with the directory
+        bool UsesDiskCache(const Entry* entry) const {
+            return !m_config.disk_cache_directory.empty() && entry->file && !entry->is_encrypted && !entry->is_inline &&
+                entry->uncompressed_size >= m_config.disk_cache_min_size;
         }
 
-        void Clear() noexcept {
-            m_entries.clear();
-            m_filepath.clear();
-            if (m_reader.is_open()) m_reader.close();
+        static uint64_t ProcessId() {
+#if defined(_WIN32)
+            return GetCurrentProcessId();
+#elif defined(__unix__) || defined(__APPLE__)
+            return static_cast<uint64_t>(getpid());
+#else
+            return 0;
+#endif
         }
 
-        std::vector<std::string> List() const {
-            std::vector<std::string> names;
-            for (const auto& [name, _] : m_entries) names.push_back(name);
-            std::sort(names.begin(), names.end());
-            return names;
+        static std::string HexName(uint64_t value) {
+            char name[17];
+            std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(value));
+            return name;
         }
 
-        std::vector<FileInfo> ListDetailed() const {
-            std::vector<FileInfo> infos;
-            for (const auto& [_, entry] : m_entries) {
-                infos.push_back({ entry->name, entry->stored_name, entry->uncompressed_size,
-                               entry->compressed_size, entry->crc32, entry->is_encrypted, entry->is_loaded });
-            }
-            return infos;
+        // Versions of one package sit side by side under a directory named from its path
+        fs::path DiskCacheDirectory(const PackageFile& file) const {
+            return fs::path(m_config.disk_cache_directory) / HexName(file.source) / HexName(file.identity);
         }
 
-        size_t GetFileCount() const noexcept { return m_entries.size(); }
+        fs::path DiskCachePath(const Entry* entry) const {
+            char name[64];
+            std::snprintf(name, sizeof(name), "%08x-%08x-%08x.bin", hash::MurmurHash3(entry->name.data(), entry->name.size()),
+                entry->crc32, entry->uncompressed_size);
+            return DiskCacheDirectory(*entry->file) / name;
+        }
 
-        size_t GetTotalSize() const noexcept {
-            size_t total = 0;
-            for (const auto& [_, entry] : m_entries) total += entry->uncompressed_size;
-            return total;
+        uint64_t DiskCacheLimit() const {
+            return m_config.disk_cache_max_size ? m_config.disk_cache_max_size : UINT64_MAX;
         }
 
-        size_t GetCompressedSize() const noexcept {
-            size_t total = 0;
-            for (const auto& [_, entry] : m_entries) total += entry->compressed_size;
-            return total;
+        // Copies left by older versions of the same package file are removed when a version is loaded; other
+        // packages sharing the directory are left alone. The current version is counted and trimmed to disk_cache_max_size.
+        void PrepareDiskCache(const PackageFile& file) {
+            if (m_config.disk_cache_directory.empty()) return;
+            fs::path directory = DiskCacheDirectory(file);
+            std::string current = directory.filename().string();
+            std::lock_guard lock(m_disk_cache_mutex);
+            m_disk_mappings.clear();
+            m_disk_cache_used = 0;
+            std::error_code ec;
+            for (fs::directory_iterator it(directory.parent_path(), ec), end; !ec && it != end; it.increment(ec)) {
+                std::string name = it->path().filename().string();
+                bool is_version = name.size() == current.size() && name.find_first_not_of("0123456789abcdef") == std::string::npos;
+                std::error_code ignored;
+                if (is_version && name != current) fs::remove_all(it->path(), ignored);
+            }
+            for (fs::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+                std::error_code ignored;
+                if (it->is_regular_file(ignored)) m_disk_cache_used += it->file_size(ignored);
+            }
+            TrimDiskCacheLocked(directory, DiskCacheLimit());
         }
 
-        float GetCompressionRatio() const noexcept {
-            size_t total = GetTotalSize();
-            if (total == 0) return 0.0f;
-            return 1.0f - (static_cast<float>(GetCompressedSize()) / total);
+        bool ReadDiskCache(Entry* entry, uint8_t* dst) {
+            if (entry->disk_cache_state.load(std::memory_order_relaxed) == Entry::DiskCacheState::Absent) return false;
+            std::string path = DiskCachePath(entry).string();
+            std::shared_ptr<const MappedFile> mapped;
+            {
+                std::lock_guard lock(m_disk_cache_mutex);
+                if (auto it = m_disk_mappings.find(path); it != m_disk_mappings.end()) mapped = it->second;
+            }
+            if (!mapped) {
+                // Checked once when mapped; the file is never rewritten under the same name
+                std::shared_ptr<const MappedFile> opened = MappedFile::Open(path);
+                if (!opened || opened->Size() != entry->uncompressed_size ||
+                    (m_config.verify_checksums && pak_utils::CalculateCRC32(opened->Data(), opened->Size()) != entry->crc32)) {
+                    entry->disk_cache_state.store(Entry::DiskCacheState::Absent, std::memory_order_relaxed);
+                    return false;
+                }
+                std::lock_guard lock(m_disk_cache_mutex);
+                mapped = m_disk_mappings.try_emplace(std::move(path), std::move(opened)).first->second;
+            }
+            std::memcpy(dst, mapped->Data(), mapped->Size());
+            entry->disk_cache_state.store(Entry::DiskCacheState::Present, std::memory_order_relaxed);
+            return true;
         }
 
-        void PrintStatistics() const {
-            std::cout << "\n=== RBPak Statistics ===" << std::endl;
-            std::cout << "Files: " << GetFileCount() << std::endl;
-            std::cout << "Total Size: " << pak_utils::FormatSize(GetTotalSize()) << std::endl;
-            std::cout << "Compressed: " << pak_utils::FormatSize(GetCompressedSize()) << std::endl;
-            if (GetTotalSize() > 0) {
-                std::cout << "Ratio: " << std::fixed << std::setprecision(2) << (GetCompressionRatio() * 100.0f) << "%" << std::endl;
+        // Deletes the oldest copies in directory until it holds at most limit bytes; mappings already
+        // handed out stay valid after their file is gone
+        void TrimDiskCacheLocked(const fs::path& directory, uint64_t limit) {
+            if (m_disk_cache_used <= limit) return;
+            std::vector<std::pair<fs::file_time_type, fs::path>> files;
+            std::error_code ec;
+            for (fs::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+                std::error_code ignored;
+                if (it->path().extension() == ".bin") files.emplace_back(it->last_write_time(ignored), it->path());
+            }
+            std::sort(files.begin(), files.end());
+            for (const auto& [_, path] : files) {
+                if (m_disk_cache_used <= limit) break;
+                std::error_code ignored;
+                uint64_t freed = fs::file_size(path, ignored);
+                if (ignored || !fs::remove(path, ignored)) continue;
+                m_disk_cache_used -= std::min(m_disk_cache_used, freed);
+                m_disk_mappings.erase(path.string());
             }
-            std::cout << "Encrypted: " << (m_config.encryption != EncryptionMethod::None ? "Yes" : "No") << std::endl;
-            std::cout << "Obfuscated: " << (m_config.obfuscate_filenames ? "Yes" : "No") << std::endl;
         }
 
-        const PackageConfig& GetConfig() const noexcept { return m_config; }
-        PackageError GetLastError() const noexcept { return m_last_error.load(); }
-        void ClearCache() noexcept { m_cache.Clear(); }
-        size_t GetCacheSize() const noexcept { return m_cache.Size(); }
+        bool ReserveDiskCache(const fs::path& directory, uint64_t size) {
+            uint64_t limit = DiskCacheLimit();
+            if (size > limit) return false;
+            std::lock_guard lock(m_disk_cache_mutex);
+            TrimDiskCacheLocked(directory, limit - size);
+            if (m_disk_cache_used + size > limit) return false;
+            m_disk_cache_used += size;
+            return true;
+        }
 
-    private:
-        PackageResult LoadEntry(Entry* entry) {
-            if (!m_reader.is_open()) return PackageResult::Failure(PackageError::IOError, "Package not open");
-            ByteArray compressed(entry->compressed_size);
-            m_reader.seekg(entry->offset);
-            if (!m_reader.read(reinterpret_cast<char*>(compressed.data()), entry->compressed_size)) {
+        // Best effort: written to a temporary name and renamed so other processes never see partial files
+        void WriteDiskCache(Entry* entry, const uint8_t* data) {
+            if (entry->disk_cache_state.load(std::memory_order_relaxed) == Entry::DiskCacheState::Present) return;
+            if (entry->disk_cache_hits.fetch_add(1, std::memory_order_relaxed) + 1 < m_config.disk_cache_min_hits) return;
+            fs::path path = DiskCachePath(entry);
+            std::error_code ec;
+            fs::create_directories(path.parent_path(), ec);
+            if (!ReserveDiskCache(path.parent_path(), entry->uncompressed_size)) return;
+            auto release = [&] {
+                std::lock_guard lock(m_disk_cache_mutex);
+                m_disk_cache_used -= std::min<uint64_t>(m_disk_cache_used, entry->uncompressed_size);
+            };
+            fs::path temp = path;
+            temp += ".tmp" + std::to_string(ProcessId()) + "-" +
+                std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+            {
+                std::ofstream file(temp, std::ios::binary);
+                if (!file.write(reinterpret_cast<const char*>(data), entry->uncompressed_size)) {
+                    file.close();
+                    fs::remove(temp, ec);
+                    release();
+                    return;
+                }
+            }
+            fs::rename(temp, path, ec);
+            if (ec) {
+                fs::remove(temp, ec);
+                release();
+                return;
+            }
+            entry->disk_cache_state.store(Entry::DiskCacheState::Present, std::memory_order_relaxed);
+        }
+
+        PackageResult ReadStored(const Entry* entry, uint8_t* dst) {
+            if (entry->is_inline) {
+                std::copy(entry->inline_data.begin(), entry->inline_data.end(), dst);
+                return PackageResult::Success();
+            }
+            if (!entry->file) return PackageResult::Failure(PackageError::IOError, "Package not open");
+            if (!entry->file->reader->Read(entry->offset, dst, entry->compressed_size)) {
                 return PackageResult::Failure(PackageError::IOError, "Read failed");
             }
-            ByteArray decompressed;
-            if (auto result = compression::Decompress(compressed.data(), compressed.size(), decompressed, entry->uncompressed_size); !result) {
+            return PackageResult::Success();
+        }
+
+        PackageResult DecodeEntry(const Entry* entry, const uint8_t* src, size_t src_size, uint8_t* dst) const {
+            if (entry->is_chunked) return DecodeChunked(entry, src, src_size, dst);
+            if (entry->is_stored) {
+                if (src_size != entry->uncompressed_size) {
+                    return PackageResult::Failure(PackageError::CorruptedData, "Stored size mismatch");
+                }
+                std::copy(src, src + src_size, dst);
+            }
+            else if (auto result = compression::Decompress(src, src_size, dst, entry->uncompressed_size); !result) {
                 return result;
             }
             if (entry->is_encrypted && m_cipher) {
-                m_cipher->Decrypt(decompressed.data(), decompressed.size());
+                m_cipher->Decrypt(dst, entry->uncompressed_size);
             }
             if (m_config.verify_checksums) {
-                uint32_t calc = pak_utils::CalculateCRC32(decompressed.data(), decompressed.size());
+                uint32_t calc = pak_utils::CalculateCRC32(dst, entry->uncompressed_size);
                 if (!pak_utils::SecureCompare(calc, entry->crc32)) {
                     return PackageResult::Failure(PackageError::ChecksumMismatch, "CRC mismatch");
                 }
             }
-            entry->data = std::move(decompressed);
-            entry->is_loaded = true;
+            return PackageResult::Success();
+        }
+
+        // Each block inflates into its own region of dst; block CRCs are combined afterwards
+        PackageResult DecodeChunked(const Entry* entry, const uint8_t* src, size_t src_size, uint8_t* dst) const {
+            chunked::Layout layout;
+            if (!chunked::ParseLayout(src, src_size, entry->uncompressed_size, layout)) {
+                return PackageResult::Failure(PackageError::CorruptedData, "Invalid block table");
+            }
+            size_t count = layout.sizes.size();
+            std::vector<uint32_t> crcs(count, 0);
+            std::vector<PackageResult> results(count, PackageResult::Success());
+            bool verify = m_config.verify_checksums;
+            JobSystem* jobs = entry->uncompressed_size >= m_config.parallel_threshold ? &Jobs() : nullptr;
+
+            parallel::For(jobs, count, [&](size_t i) {
+                size_t begin = i * layout.block_size;
+                size_t length = std::min<size_t>(layout.block_size, entry->uncompressed_size - begin);
+                results[i] = compression::Decompress(src + layout.offsets[i], layout.sizes[i], dst + begin, length);
+                if (!results[i]) return;
+                if (entry->is_encrypted && m_cipher) {
+                    m_cipher->Decrypt(dst + begin, length, begin);
+                }
+                if (verify) crcs[i] = pak_utils::CalculateCRC32(dst + begin, length);
+            });
+
+            for (const auto& result : results) {
+                if (!result) return result;
+            }
+            if (verify) {
+                uLong crc = crcs[0];
+                for (size_t i = 1; i < count; ++i) {
+                    size_t length = std::min<size_t>(layout.block_size, entry->uncompressed_size - i * layout.block_size);
+                    crc = crc32_combine(crc, crcs[i], static_cast<z_off_t>(length));
+                }
+                if (!pak_utils::SecureCompare(static_cast<uint32_t>(crc), entry->crc32)) {
+                    return PackageResult::Failure(PackageError::ChecksumMismatch, "CRC mismatch");
+                }
+            }
+            return PackageResult::Success();
+        }
+
+        PackageResult CompressChunked(const uint8_t* input, size_t size, Blob& output) {
+            uint32_t block_size = static_cast<uint32_t>(std::clamp<size_t>(m_config.chunk_size, 4096, UINT32_MAX));
+            size_t count = (size + block_size - 1) / block_size;
+            std::vector<BufferPool::Lease> blocks(count);
+            std::vector<PackageResult> results(count, PackageResult::Success());
+
+            parallel::For(&Jobs(), count, [&](size_t i) {
+                size_t begin = i * block_size;
+                size_t length = std::min<size_t>(block_size, size - begin);
+                blocks[i] = m_buffer_pool.Acquire(compressBound(static_cast<uLong>(length)));
+                results[i] = compression::Compress(input + begin, length, *blocks[i], m_config.compression);
+            });
+
+            for (const auto& result : results) {
+                if (!result) return result;
+            }
+            size_t total = chunked::HEADER_SIZE + count * sizeof(uint32_t);
+            for (auto& block : blocks) total += block->size();
+            output.clear();
+            output.reserve(total);
+            auto append = [&output](uint32_t value) {
+                const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+                output.insert(output.end(), bytes, bytes + sizeof(value));
+            };
+            append(block_size);
+            append(static_cast<uint32_t>(count));
+            for (auto& block : blocks) append(static_cast<uint32_t>(block->size()));
+            for (auto& block : blocks) output.insert(output.end(), block->begin(), block->end());
             return PackageResult::Success();
         }
     };
@@ -599,6 +4573,14 @@ namespace rbpak {
         return m_impl->Get(name);
     }
 
+    std::optional<size_t> Package::GetSize(std::string_view name) const {
+        return m_impl->GetSize(name);
+    }
+
+    PackageResult Package::GetInto(std::string_view name, std::span<uint8_t> dest, bool cache) {
+        return m_impl->GetInto(name, dest, cache);
+    }
+
     PackageResult Package::Extract(std::string_view name, std::string_view output_path) {
         return m_impl->Extract(name, output_path);
     }
@@ -607,6 +4589,10 @@ namespace rbpak {
         return m_impl->ExtractAll(output_directory, callback);
     }
 
+    PackageResult Package::VerifyAll(ProgressCallback callback) {
+        return m_impl->VerifyAll(callback);
+    }
+
     bool Package::Remove(std::string_view name) {
         return m_impl->Remove(name);
     }
@@ -627,6 +4613,10 @@ namespace rbpak {
         return m_impl->Load(filepath);
     }
 
+    PackageResult Package::Reload(std::string_view filepath) {
+        return m_impl->Reload(filepath);
+    }
+
     void Package::Clear() noexcept {
         m_impl->Clear();
     }
@@ -663,6 +4653,118 @@ namespace rbpak {
         return m_impl->GetCacheSize();
     }
 
+    size_t Package::GetCompressedCacheSize() const noexcept {
+        return m_impl->GetCompressedCacheSize();
+    }
+
+    bool Package::HasSharedCache() const noexcept {
+        return m_impl->HasSharedCache();
+    }
+
+    PackageResult Package::SaveCacheManifest(std::string_view path) const {
+        return m_impl->SaveCacheManifest(path);
+    }
+
+    PackageResult Package::WarmFromManifest(std::string_view path, size_t budget) {
+        return m_impl->WarmFromManifest(path, budget);
+    }
+
+    void Package::WaitForWarmup() {
+        m_impl->WaitForWarmup();
+    }
+
+    PackageResult Package::SetDependencies(std::string_view name, const std::vector<std::string>& dependencies) {
+        return m_impl->SetDependencies(name, dependencies);
+    }
+
+    std::vector<std::string> Package::GetDependencies(std::string_view name) const {
+        return m_impl->GetDependencies(name);
+    }
+
+    std::optional<std::vector<std::pair<std::string, ByteArray>>> Package::GetWithDependencies(std::string_view name) {
+        return m_impl->GetWithDependencies(name);
+    }
+
+    PackageResult Package::PrefetchClosure(std::string_view name) {
+        return m_impl->PrefetchClosure(name);
+    }
+
+    PackageResult Package::DefineBundle(std::string_view bundle, const std::vector<std::string>& members) {
+        return m_impl->DefineBundle(bundle, members);
+    }
+
+    std::vector<std::string> Package::ListBundles() const {
+        return m_impl->ListBundles();
+    }
+
+    std::vector<std::string> Package::GetBundle(std::string_view bundle) const {
+        return m_impl->GetBundle(bundle);
+    }
+
+    PackageResult Package::LoadBundle(std::string_view bundle) {
+        return m_impl->LoadBundle(bundle);
+    }
+
+    PackageResult Package::WarmPageCache(const std::vector<std::string>& names) {
+        return m_impl->WarmPageCache(names);
+    }
+
+    PackageResult Package::DropPageCache(const std::vector<std::string>& names) {
+        return m_impl->DropPageCache(names);
+    }
+
+    PackageResult Package::SavePrefetchModel(std::string_view path) const {
+        return m_impl->SavePrefetchModel(path);
+    }
+
+    PackageResult Package::LoadPrefetchModel(std::string_view path) {
+        return m_impl->LoadPrefetchModel(path);
+    }
+
+    PrefetchStats Package::GetPrefetchStats() const {
+        return m_impl->GetPrefetchStats();
+    }
+
+    PackageResult Package::Pin(std::string_view name) {
+        return m_impl->Pin(name);
+    }
+
+    bool Package::Unpin(std::string_view name) {
+        return m_impl->Unpin(name);
+    }
+
+    bool Package::SetCachePriority(std::string_view name, CachePriority priority) {
+        return m_impl->SetCachePriority(name, priority);
+    }
+
+    size_t Package::GetPinnedSize() const noexcept {
+        return m_impl->GetPinnedSize();
+    }
+
+    void Package::SetCacheCapacity(size_t bytes) {
+        m_impl->SetCacheCapacity(bytes);
+    }
+
+    size_t Package::GetCacheCapacity() const noexcept {
+        return m_impl->GetCacheCapacity();
+    }
+
+    void Package::OnMemoryPressure(MemoryPressure level) {
+        m_impl->OnMemoryPressure(level);
+    }
+
+    MemoryPressure Package::GetMemoryPressure() const noexcept {
+        return m_impl->GetMemoryPressure();
+    }
+
+    std::vector<MissRatioPoint> Package::GetMissRatioCurve() const {
+        return m_impl->GetMissRatioCurve();
+    }
+
+    BufferPoolStats Package::GetBufferPoolStats() const {
+        return m_impl->GetBufferPoolStats();
+    }
+
     void Package::PrintStatistics() const {
         m_impl->PrintStatistics();
     }